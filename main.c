@@ -1,21 +1,30 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 #include <errno.h>
+#include <stdarg.h>
 #include <time.h>
+#include <stdatomic.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#  include <immintrin.h>
+#  define HAVE_X86_SIMD 1
+#endif
 
 #ifdef _WIN32
 #  include <windows.h>
 #  include <conio.h>
 #  include <io.h>
-#  include <malloc.h>
-#  ifndef alloca
-#    define alloca _alloca
-#  endif
 #else
 #  include <unistd.h>
 #  include <termios.h>
 #  include <dirent.h>
+#  include <sys/stat.h>
+#  include <sys/mman.h>
+#  include <fcntl.h>
+#  include <poll.h>
+#  include <pthread.h>
 #endif
 
 #define RED   "\x1b[31m"
@@ -26,18 +35,10 @@
 #define NOT_FINISHED 0
 #define WIN 1
 #define IMPOSSIBLE 2
+#define CONFLICT 3 /* propagation reached a contradiction */
 #define LIKELY(x)   __builtin_expect(!!(x), 1)
 #define UNLIKELY(x) __builtin_expect(!!(x), 0)
 
-#define mesure(instruction) \
-    do { \
-        clock_t start = clock(); \
-        instruction; \
-        clock_t end = clock(); \
-        double time_spent = ((double)(end - start)) / CLOCKS_PER_SEC * 1000000; /* Convert to microseconds */ \
-        printf("Executed in %.0f micro seconds\n", time_spent); \
-    } while (0)
-
 #define GetCellPtr(game, i, j) ((i) < (game)->size && (j) < (game)->size ? &((game)->array[(i) * (game)->size + (j)]) : NULL)
 
 #define da_append(xs, x)                                                             \
@@ -68,18 +69,180 @@ typedef struct __attribute__((packed)) Game_s {
     size_t selected;
 } Game;
 
-typedef size_t (*Rule)(Game*);
+/* Bitboard state: each row and each column kept as a pair of masks, bit j = cell j */
+typedef uint64_t Line;
+#define BIT_MAX_SIZE 64
+
+/* Why a cell was written, for conflict analysis: a given, a branch or a probe (implied by the
+   branches above it), a learned nogood, or a line rule on its row or column, WHY_WIDE when the
+   rule also looked at the complete parallel lines */
+enum { WHY_SET, WHY_NOGOOD, WHY_ROW, WHY_COL, WHY_WIDE = 4 };
+
+typedef struct {
+    uint8_t i, j, v;
+    uint8_t why;
+} TrailEntry;
+
+typedef struct BitGame_s BitGame;
+
+/* BitPropagate compiled for one grid size, see PropagatorFor */
+typedef size_t (*Propagator)(BitGame *bg);
+
+/* Intersect the candidates of a pattern table that match a partial line (zeros, ones) and are
+   none of the twins: AND into *all, OR into *any. Returns how many there were. See PatternScanFor. */
+typedef size_t (*PatternScan)(const Line *items, size_t count, Line zeros, Line ones,
+                              const Line *twins, size_t twinCount, Line *all, Line *any);
+
+/* The line rules, cheapest first: a line is only handed to the next rule when the previous
+   ones left it unchanged. The last column says whether a rule reads the complete parallel lines. */
+#define LINE_RULES(X)                              \
+    X(LineAdjacentPair,   "BitAdjacentPair",   0)  \
+    X(LineQuotaExhausted, "BitQuotaExhausted", 0)  \
+    X(LineUniqueness,     "BitUniqueness",     1)  \
+    X(LinePatterns,       "BitPatterns",       1)
+
+#define COUNT_LINE_RULE(kernel, name, wide) + 1
+enum { LINE_RULE_COUNT = 0 LINE_RULES(COUNT_LINE_RULE) };
+#undef COUNT_LINE_RULE
+
+/* Counted by BitPropagate on every call: a few increments per line, cheap enough to stay on */
+typedef struct {
+    size_t passes;                      /* BitPropagate calls */
+    size_t lines;                       /* lines taken off the dirty queues */
+    size_t ruleCalls[LINE_RULE_COUNT];  /* lines each rule looked at */
+    size_t ruleCells[LINE_RULE_COUNT];  /* cells each rule filled */
+} PropagationStats;
+
+/* Transposition table: partial grids known to be dead, or to have exactly `solutions`
+   completions, by Zobrist hash. Both are properties of the grid alone, so entries stay valid
+   from one search to the next. Two entries per bucket: the first keeps the state whose subtree
+   took the most work, the second takes whatever comes. */
+typedef struct {
+    uint64_t key;        /* 0: free */
+    uint32_t work;       /* nodes the subtree took, saturated */
+    uint32_t solutions;  /* 0: dead */
+} TransEntry;
+
+typedef struct {
+    TransEntry *entries; /* 2 per bucket */
+    size_t mask;         /* buckets - 1 */
+} TransTable;
+
+struct BitGame_s {
+    size_t size;
+    Line full;      /* the `size` low bits */
+    Propagator propagate;
+    PatternScan scan;
+    Line *rows[2];  /* rows[v][i]: cells of row i holding '0'+v */
+    Line *cols[2];  /* cols[v][j]: cells of column j holding '0'+v, transposed copy of rows */
+    Line dirty[2];  /* rows (0) and columns (1) written since their rules last ran */
+    Line complete[2]; /* rows (0) and columns (1) with no empty cell left */
+    Line broken[2];   /* complete lines breaking a rule: a triple, unbalanced or equal to another */
+    Line *seen[2];    /* ones masks of the other complete lines, open addressing, 0 for a free slot */
+    size_t seenMask;  /* slots per set - 1 */
+    TrailEntry *trail; /* every cell written, in order, so a search can roll back */
+    size_t trailLen;
+    int inArena;       /* lines and trail belong to an arena, FreeBitGame leaves them */
+    uint64_t hash;     /* Zobrist hash of the size and of every cell written */
+    TransTable *tt;    /* optional, see TransTable */
+    uint8_t why;        /* reason recorded with the cells written next, see WHY_SET */
+    TrailEntry conflict; /* the line (i for a row, j for a column) or nogood behind the last CONFLICT */
+    size_t watched;     /* trail entries already checked against the learned nogoods */
+    PropagationStats prop;
+};
+
+/* Variable selection: store the next cell to branch on in idx, return 0 when the grid is full */
+typedef int (*Brancher)(BitGame *bg, size_t *idx);
+typedef struct {
+    const char *name;
+    Brancher pick;
+    int lookahead;   /* failed-literal probing before each pick, see BitProbe */
+    size_t learn;    /* Solve only: nogoods kept by conflict-driven learning, 0 for none, see BitLearn */
+    size_t restart;  /* Solve only: restart unit in nodes, 0 for a single run, see BitSolveRestarts */
+} BranchStrategy;
+
+typedef struct {
+    size_t nodes;       /* branch values tried */
+    size_t backtracks;  /* branch values refuted */
+    size_t maxDepth;    /* deepest branch, in decisions */
+    uint64_t propagateNs; /* time in BitPropagate, out of the whole search */
+    uint64_t branchNs;    /* time picking branch cells (probing propagates in there too) */
+    size_t ttHits;        /* states answered by the transposition table */
+    size_t ttMisses;
+    size_t probes;        /* literals tried by BitProbe */
+    size_t probeFixed;    /* cells BitProbe fixed without branching */
+    uint64_t probeNs;
+    size_t learned;       /* nogoods learned from conflicts */
+    size_t jumped;        /* decision levels skipped by backjumps */
+    size_t nogoodFixed;   /* cells forced by learned nogoods */
+    size_t restarts;      /* runs cut short by their node budget */
+    PropagationStats prop;
+} SolverStats;
+
+typedef void (*SolutionFn)(const BitGame *bg, void *ctx);
+
+/* A learned nogood: cell values that cannot all hold, lits[0..len) in the learner's pool. It is
+   watched on lits[0] and lits[1]; next[k] is the following nogood watching the same literal as
+   lits[k], as (id << 1 | k). */
+typedef struct {
+    uint32_t start;
+    uint32_t len;
+    uint32_t activity;  /* conflicts it took part in, halved at each cleanup */
+    uint32_t next[2];
+} Nogood;
+
+#define NO_NOGOOD UINT32_MAX
+
+/* Conflict-driven learning for a search that stops at its first solution, see BitLearn. Sized
+   for one grid; the scratch arrays are per cell, cell = i * size + j. */
 typedef struct {
-    int *items;
+    Nogood *nogoods;
     size_t count;
-    size_t capacity;
-} Indexes;
+    size_t capacity;     /* when full, the least active half goes, see ReduceNogoods */
+    TrailEntry *lits;    /* the literals of every nogood, in order */
+    size_t litCount;
+    size_t litCapacity;
+    uint32_t *watches;   /* per literal, (cell << 1 | v): first nogood watching it */
+    uint32_t *reason;    /* per cell: the nogood that forced it */
+    size_t *levelStart;  /* trail length before the decision of each depth */
+    uint32_t *pos, *level, *cells, *lower;
+    uint8_t *seen;
+    uint64_t *keys;      /* for ReduceNogoods */
+    uint32_t *remap;
+    uint32_t pending;    /* learned at the last conflict, asserted after the backjump */
+    uint32_t conflict;   /* the nogood found violated */
+    void *block;         /* everything above, when it is not in an arena */
+} Learner;
+
+typedef struct Solver_s {
+    BitGame bg;
+    const BranchStrategy *strategy;
+    SolverStats stats;
+    atomic_int *cancel;     /* optional: set by another thread to stop the search */
+    size_t limit;           /* stop after this many solutions, 0 for all of them */
+    size_t solutions;       /* found so far */
+    SolutionFn onSolution;  /* optional: called with every solution found */
+    void *solutionCtx;
+    uint64_t rng;           /* non-zero: random value order at each branch, from this state */
+    size_t depth;           /* decisions on the current branch */
+    int countOnly;          /* solutions are only counted: a cached count can stand for a subtree */
+    Learner *learn;         /* optional, only where the search stops at its first solution */
+    size_t jumpTo;          /* backjumping to depth jumpTo - 1, 0 when not */
+    size_t budget;          /* non-zero: give up once stats.nodes goes past it */
+} Solver;
+
+/* A branch taken by the search: cell index and value */
+typedef struct {
+    uint16_t cell;
+    uint8_t v;
+} Decision;
 
-/* Debug: solution reference for solver validation */
-static char *g_solution = NULL;
-static size_t g_solution_size = 0;
-size_t PrintAndDebug = 0; //[CB]: 0;|1;
+/* Debug: solution reference for solver validation, per thread so batch workers never share it */
+static _Thread_local char *g_solution = NULL;
+static _Thread_local size_t g_solution_size = 0;
+size_t PrintAndDebug = 0; //[CB]: 0;|1;  (never written once solving starts)
 static int g_force_redraw = 1;
+static char g_message[256]; /* shown under the grid by the next frame, '\n' starts its second line */
 
 
 /* Mode terminal raw (capture touches sans Enter) */
@@ -89,6 +252,8 @@ static HANDLE hConsoleOut;
 
 void disableRawMode(void) { /* no-op on Windows: _getch() needs no teardown */ }
 
+int InputPending(void) { return _kbhit(); }
+
 void enableRawMode(void)
 {
     /* Enable ANSI/VT escape-sequence processing so colours work in cmd/PowerShell */
@@ -130,8 +295,262 @@ void enableRawMode(void)
     }
 }
 
+/* Nonzero when a key is already waiting to be read */
+int InputPending(void)
+{
+    struct pollfd p = { .fd = STDIN_FILENO, .events = POLLIN };
+    return poll(&p, 1, 0) > 0;
+}
+
+#endif /* _WIN32 */
+
+
+/* Threads and locks */
+#ifdef _WIN32
+
+typedef HANDLE Thread;
+typedef SRWLOCK Mutex;
+#  define MUTEX_INIT SRWLOCK_INIT
+#  define THREAD_MAIN(name, arg) DWORD WINAPI name(LPVOID arg)
+
+static inline void MutexLock(Mutex *m) { AcquireSRWLockExclusive(m); }
+static inline void MutexUnlock(Mutex *m) { ReleaseSRWLockExclusive(m); }
+
+static int ThreadStart(Thread *t, LPTHREAD_START_ROUTINE fn, void *arg)
+{
+    *t = CreateThread(NULL, 0, fn, arg, 0, NULL);
+    return *t != NULL;
+}
+
+static void ThreadJoin(Thread t)
+{
+    WaitForSingleObject(t, INFINITE);
+    CloseHandle(t);
+}
+
+static size_t CpuCount(void)
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors ? info.dwNumberOfProcessors : 1;
+}
+
+#else /* POSIX */
+
+typedef pthread_t Thread;
+typedef pthread_mutex_t Mutex;
+#  define MUTEX_INIT PTHREAD_MUTEX_INITIALIZER
+#  define THREAD_MAIN(name, arg) void *name(void *arg)
+
+static inline void MutexLock(Mutex *m) { pthread_mutex_lock(m); }
+static inline void MutexUnlock(Mutex *m) { pthread_mutex_unlock(m); }
+
+static int ThreadStart(Thread *t, void *(*fn)(void*), void *arg)
+{
+    return pthread_create(t, NULL, fn, arg) == 0;
+}
+
+static void ThreadJoin(Thread t)
+{
+    pthread_join(t, NULL);
+}
+
+static size_t CpuCount(void)
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (size_t)n : 1;
+}
+
 #endif /* _WIN32 */
 
+/* Monotonic clock, in nanoseconds */
+static uint64_t NowNs(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (uint64_t)(now.QuadPart / freq.QuadPart) * 1000000000ull
+         + (uint64_t)(now.QuadPart % freq.QuadPart) * 1000000000ull / (uint64_t)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/* Work-stealing pool over tasks 0..count-1. Each worker owns a contiguous range of tasks and
+   takes them from the front; a worker that runs dry steals the back half of another range,
+   so a few slow tasks never hold back the rest. */
+typedef void (*TaskFn)(void *ctx, size_t worker, size_t task);
+
+typedef struct {
+    Mutex lock;
+    size_t begin, end; /* tasks still queued */
+} WorkQueue;
+
+typedef struct {
+    WorkQueue *queues;
+    size_t workers;
+    TaskFn fn;
+    void *ctx;
+} TaskPool;
+
+typedef struct {
+    TaskPool *pool;
+    size_t id;
+} PoolWorker;
+
+static int PopTask(WorkQueue *q, size_t *task)
+{
+    MutexLock(&q->lock);
+    int found = q->begin < q->end;
+    if (found) *task = q->begin++;
+    MutexUnlock(&q->lock);
+    return found;
+}
+
+static int StealTasks(TaskPool *pool, size_t thief)
+{
+    for (size_t k = 1; k < pool->workers; k++) {
+        WorkQueue *victim = &pool->queues[(thief + k) % pool->workers];
+        size_t begin = 0, end = 0;
+        MutexLock(&victim->lock);
+        if (victim->begin < victim->end) {
+            begin = victim->end - (victim->end - victim->begin + 1) / 2;
+            end = victim->end;
+            victim->end = begin;
+        }
+        MutexUnlock(&victim->lock);
+        if (begin < end) {
+            WorkQueue *own = &pool->queues[thief];
+            MutexLock(&own->lock);
+            own->begin = begin;
+            own->end = end;
+            MutexUnlock(&own->lock);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static THREAD_MAIN(PoolWorkerMain, arg)
+{
+    PoolWorker *worker = arg;
+    TaskPool *pool = worker->pool;
+    for (;;) {
+        size_t task;
+        if (!PopTask(&pool->queues[worker->id], &task)) {
+            if (!StealTasks(pool, worker->id)) break;
+            continue;
+        }
+        pool->fn(pool->ctx, worker->id, task);
+    }
+    return 0;
+}
+
+/* Run fn(ctx, worker, task) for every task < count on up to `workers` threads, the calling
+   thread being worker 0. Returns once every task is done. */
+void RunTasks(size_t workers, size_t count, TaskFn fn, void *ctx)
+{
+    if (workers > count) workers = count;
+    if (workers <= 1) {
+        for (size_t t = 0; t < count; t++) fn(ctx, 0, t);
+        return;
+    }
+
+    TaskPool pool = { .queues = calloc(workers, sizeof(WorkQueue)), .workers = workers, .fn = fn, .ctx = ctx };
+    PoolWorker *self = calloc(workers, sizeof(PoolWorker));
+    Thread *threads = calloc(workers, sizeof(Thread));
+    if (!pool.queues || !self || !threads) {
+        perror("calloc");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t w = 0; w < workers; w++) {
+        pool.queues[w] = (WorkQueue){ .lock = MUTEX_INIT, .begin = w * count / workers, .end = (w + 1) * count / workers };
+        self[w] = (PoolWorker){ &pool, w };
+    }
+
+    size_t started = 1;
+    while (started < workers && ThreadStart(&threads[started], PoolWorkerMain, &self[started]))
+        started++;
+    /* Ranges of threads that failed to start are stolen by the others */
+    PoolWorkerMain(&self[0]);
+    for (size_t w = 1; w < started; w++) ThreadJoin(threads[w]);
+
+    free(threads);
+    free(self);
+    free(pool.queues);
+}
+
+
+/* Bump allocator for the state of one puzzle: ArenaAlloc never frees, ArenaReset drops it all.
+   When it runs out it borrows blocks from malloc until the next reset, and then grows to fit
+   them, so a worker solving puzzles back to back soon stops calling malloc at all. */
+#define ARENA_DEFAULT_SIZE (64 * 1024) /* a 64x64 puzzle needs about 24 KiB */
+
+typedef struct ArenaBlock_s {
+    struct ArenaBlock_s *next;
+    size_t pad;  /* keeps the payload 16-byte aligned */
+} ArenaBlock;
+
+typedef struct {
+    uint8_t *base;
+    size_t used;
+    size_t capacity;
+    ArenaBlock *spill;  /* borrowed blocks, freed by the next reset */
+    size_t spilled;     /* their total size */
+} Arena;
+
+Arena InitArena(size_t capacity)
+{
+    Arena arena = { .base = malloc(capacity), .capacity = capacity };
+    if (!arena.base) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    return arena;
+}
+
+void *ArenaAlloc(Arena *arena, size_t len)
+{
+    len = (len + 15) & ~(size_t)15;
+    if (LIKELY(arena->used + len <= arena->capacity)) {
+        void *p = arena->base + arena->used;
+        arena->used += len;
+        return p;
+    }
+    ArenaBlock *block = malloc(sizeof(ArenaBlock) + len);
+    if (!block) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    block->next = arena->spill;
+    arena->spill = block;
+    arena->spilled += len;
+    return block + 1;
+}
+
+void ArenaReset(Arena *arena)
+{
+    if (UNLIKELY(arena->spill)) {
+        while (arena->spill) {
+            ArenaBlock *next = arena->spill->next;
+            free(arena->spill);
+            arena->spill = next;
+        }
+        free(arena->base);
+        *arena = InitArena(arena->capacity + arena->spilled);
+    }
+    arena->used = 0;
+}
+
+void FreeArena(Arena *arena)
+{
+    ArenaReset(arena);
+    free(arena->base);
+    memset(arena, 0, sizeof(*arena));
+}
 
 Game InitGame(size_t size)
 {
@@ -146,6 +565,14 @@ Game InitGame(size_t size)
     return game;
 }
 
+/* A game in `arena`, gone at its next reset: never pass it to FreeGame */
+Game InitGameIn(Arena *arena, size_t size)
+{
+    Game game = { .size = size, .array = ArenaAlloc(arena, size * size * sizeof(Cell)), .selected = 0 };
+    memset(game.array, 0, size * size * sizeof(Cell));
+    return game;
+}
+
 void FreeGame(Game *game)
 {
     if (!game) return;
@@ -154,21 +581,31 @@ void FreeGame(Game *game)
     game->size = 0;
 }
 
-void LoadSolution(const char *path, size_t size)
+/* Read a size x size solution grid, NULL if the file is missing, too short or out of memory */
+char *ReadSolution(const char *path, size_t size)
 {
     FILE *f = fopen(path, "rb");
-    if (!f) { printf("No solution file: %s\n", path); return; }
-    g_solution_size = size;
-    g_solution = malloc(size * size);
-    for (size_t i = 0; i < size; i++) {
-        for (size_t j = 0; j < size; j++) {
-            char byte;
-            do { byte = fgetc(f); } while (byte == '\n' || byte == '\r');
-            if (byte == EOF) { fclose(f); free(g_solution); g_solution = NULL; return; }
-            g_solution[i * size + j] = byte;
-        }
+    if (!f) return NULL;
+    char *solution = malloc(size * size);
+    if (!solution) {
+        fclose(f);
+        return NULL;
+    }
+    for (size_t i = 0; i < size * size; i++) {
+        int byte;
+        do { byte = fgetc(f); } while (byte == '\n' || byte == '\r');
+        if (byte == EOF) { fclose(f); free(solution); return NULL; }
+        solution[i] = (char)byte;
     }
     fclose(f);
+    return solution;
+}
+
+void LoadSolution(const char *path, size_t size)
+{
+    g_solution = ReadSolution(path, size);
+    if (!g_solution) { printf("No solution file: %s\n", path); return; }
+    g_solution_size = size;
 }
 
 void FreeSolution(void)
@@ -192,9 +629,45 @@ static inline void debugCheckCell(Game *game, size_t idx, char newVal, const cha
 }
 
 
+/* Read the next grid of a .binero stream into game, which is reallocated to its size: the width
+   of its first line. Blank lines before a grid are skipped, the other line breaks are ignored.
+   Returns 1 on success, 0 at the end of the stream, -1 on a truncated grid, -2 on a bad width. */
+int ReadLevel(FILE *file, Game *game)
+{
+    char first[BIT_MAX_SIZE];
+    size_t size = 0;
+    int byte;
+    do {
+        byte = fgetc(file);
+    } while (byte == '\n' || byte == '\r');
+    if (byte == EOF) return 0;
+
+    for (; byte != '\n' && byte != '\r' && byte != EOF; byte = fgetc(file)) {
+        if (size == BIT_MAX_SIZE) return -2;
+        first[size++] = (char)byte;
+    }
+    if (size < 4 || size % 2) return -2;
+
+    FreeGame(game);
+    *game = InitGame(size);
+    for (size_t idx = 0; idx < size * size; idx++) {
+        if (idx < size) byte = first[idx];
+        else {
+            do {
+                byte = fgetc(file);
+            } while (byte == '\n' || byte == '\r');
+            if (byte == EOF) return -1;
+        }
+        game->array[idx].isImmutable = byte == '0' || byte == '1';
+        game->array[idx].isCommited = 0;
+        game->array[idx].value = (char)byte;
+    }
+    return 1;
+}
+
 Game LoadLevel(const char *path)
 {
-    Game game = InitGame(14);
+    Game game = {0};
     FILE* file = fopen(path, "rb");
     if (!file)
     {
@@ -202,122 +675,412 @@ Game LoadLevel(const char *path)
         exit(0);
     }
 
-    for(size_t i = 0; i < game.size; i++){
-        for(size_t j = 0; j < game.size; j++){
-            char byte;
-            do {
-                byte = fgetc(file);
-            } while (byte == '\n' || byte == '\r');
-            
-            if (byte == EOF) {
-                printf("Erreur: fichier trop court\n");
-                fclose(file);
-                return game;
-            }
-            size_t idx = i * game.size + j;
-            if (byte == '0' || byte == '1') {
-                game.array[idx].isImmutable = 1;
-            }
-            else if (byte == ' ') {
-                game.array[idx].isImmutable = 0;
-            }
-            game.array[idx].value = byte;
-        }
-    }
-fclose(file);
+    int read = ReadLevel(file, &game);
+    if (read == -2)
+        printf("Erreur: la premiere ligne doit avoir une largeur paire, de 4 a %d\n", BIT_MAX_SIZE);
+    else if (read != 1)
+        printf("Erreur: fichier trop court\n");
+    fclose(file);
 
     return game;
 }
 
-/*
-Cell* GetCellPtr(Game *game, size_t i, size_t j)
+void WriteLevel(FILE *f, const Game *game)
 {
-    if(LIKELY(i<game->size && j<game->size))
-        return &game->array[i * game->size + j];
-    return 0;
+    for (size_t i = 0; i < game->size; i++) {
+        for (size_t j = 0; j < game->size; j++) {
+            char v = game->array[i * game->size + j].value;
+            fputc((v == '0' || v == '1') ? v : ' ', f);
+        }
+        if (i < game->size - 1) fputc('\n', f);
+    }
 }
-*/
 
+/* Read-only view of a whole file */
+typedef struct {
+    const uint8_t *data;
+    size_t len;
+#ifdef _WIN32
+    HANDLE file, mapping;
+#endif
+} MappedFile;
 
-void PrintGame(Game* game)
+/* Returns 0 or an errno value */
+static int MapFile(const char *path, MappedFile *mf)
 {
-    /* Per-cell render state for differential updates */
-    typedef struct { char value; unsigned char flags; } RState;
-    static RState *prev = NULL;
-    static size_t prev_size = 0;
-
-    size_t total = game->size * game->size;
-    int full_redraw = g_force_redraw || !prev || prev_size != game->size;
+    memset(mf, 0, sizeof(*mf));
+#ifdef _WIN32
+    mf->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (mf->file == INVALID_HANDLE_VALUE) return ENOENT;
+    LARGE_INTEGER len;
+    if (!GetFileSizeEx(mf->file, &len)) {
+        CloseHandle(mf->file);
+        return EIO;
+    }
+    mf->len = (size_t)len.QuadPart;
+    if (mf->len == 0) return 0;
+    mf->mapping = CreateFileMappingA(mf->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mf->mapping) mf->data = MapViewOfFile(mf->mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!mf->data) {
+        if (mf->mapping) CloseHandle(mf->mapping);
+        CloseHandle(mf->file);
+        return EIO;
+    }
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return errno;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        int err = errno;
+        close(fd);
+        return err;
+    }
+    mf->len = (size_t)st.st_size;
+    if (mf->len) {
+        void *data = mmap(NULL, mf->len, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            int err = errno;
+            close(fd);
+            return err;
+        }
+        /* A batch reads the whole corpus: start paging it in now */
+        madvise(data, mf->len, MADV_WILLNEED);
+        mf->data = data;
+    }
+    close(fd);
+#endif
+    return 0;
+}
 
-    if (full_redraw) {
-        free(prev);
-        prev = malloc(total * sizeof(*prev));
-        memset(prev, 0xFF, total * sizeof(*prev)); /* force every cell diff */
-        prev_size = game->size;
-        g_force_redraw = 0;
+static void UnmapFile(MappedFile *mf)
+{
+#ifdef _WIN32
+    if (mf->data) UnmapViewOfFile(mf->data);
+    if (mf->mapping) CloseHandle(mf->mapping);
+    CloseHandle(mf->file);
+#else
+    if (mf->data) munmap((void *)mf->data, mf->len);
+#endif
+    memset(mf, 0, sizeof(*mf));
+}
 
-        /* Clear screen and draw static parts */
-        printf("\x1b[H\x1b[2J\x1b[3J\x1b[?25l");
+/* Packed corpus (.binpack), little-endian:
+     "BNRP", version, grid size, flags, 0, puzzle count (u64)
+     count puzzles of size*size/4 bytes: 2 bits per cell, row-major, low bits first
+       (0 empty, 1 for '0', 2 for '1')
+     with PACK_HAS_SOLUTIONS, their solutions in the same layout */
+#define PACK_HEADER_SIZE 16
+#define PACK_VERSION 1
+#define PACK_HAS_SOLUTIONS 1
 
-        /* Header at row 1 */
-        printf("\x1b[1;1H   ");
-        for (size_t j = 0; j < game->size; j++)
-            printf(" %c", 'a' + (char)j);
+/* OpenPack errors, after ReadLevel's -1 and -2; positive values are errno values */
+#define PACK_NOT_A_PACK   -3
+#define PACK_BAD_VERSION  -4
+#define PACK_BAD_SIZE     -5
+#define PACK_TRUNCATED    -6
 
-        /* Row labels and pipe skeleton */
-        for (size_t i = 0; i < game->size; i++) {
-            printf("\x1b[%zu;1H%2zu:|", i + 2, i + 1);
-            for (size_t j = 0; j < game->size; j++)
-                printf(" |");
-        }
+typedef struct {
+    char *path;
+    MappedFile file;
+    size_t size;
+    size_t count;
+    size_t recordLen;
+    const uint8_t *puzzles;    /* straight into the mapping, never copied */
+    const uint8_t *solutions;  /* NULL if the pack has none */
+} Pack;
 
-        /* Footer */
-        printf("\x1b[%zu;1H" "Fleches: nav|'a'/'e'->'0'/'1'|'r'emove | 'c'ommit | 'x'port | 'q'uit",
-               game->size + 2);
-    }
+static int IsPackName(const char *name)
+{
+    size_t len = strlen(name);
+    return len > 8 && strcmp(name + len - 8, ".binpack") == 0;
+}
 
-    /* Clear message area (2 lines) */
-    printf("\x1b[%zu;1H\x1b[2K\x1b[%zu;1H\x1b[2K",
-           game->size + 3, game->size + 4);
+static void ClosePack(Pack *pack)
+{
+    UnmapFile(&pack->file);
+    free(pack->path);
+    memset(pack, 0, sizeof(*pack));
+}
 
-    /* Update only changed cells */
-    for (size_t i = 0; i < game->size; i++) {
-        for (size_t j = 0; j < game->size; j++) {
-            size_t idx = i * game->size + j;
-            Cell *cell = &game->array[idx];
-            unsigned char sel = (idx == game->selected) ? 1 : 0;
-            unsigned char flags = (unsigned char)(
-                (cell->isImmutable ? 1u : 0u) |
-                (cell->isCommited  ? 2u : 0u) |
-                (sel               ? 4u : 0u));
+/* Returns 0 or an error code (see ReadErrorString) */
+static int OpenPack(const char *path, Pack *pack)
+{
+    memset(pack, 0, sizeof(*pack));
+    int err = MapFile(path, &pack->file);
+    if (err) return err;
 
-            if (prev[idx].value == cell->value && prev[idx].flags == flags)
-                continue;
+    const uint8_t *h = pack->file.data;
+    if (pack->file.len < PACK_HEADER_SIZE || memcmp(h, "BNRP", 4) != 0)
+        err = PACK_NOT_A_PACK;
+    else if (h[4] != PACK_VERSION)
+        err = PACK_BAD_VERSION;
+    else if (h[5] < 4 || h[5] > BIT_MAX_SIZE || h[5] % 2)
+        err = PACK_BAD_SIZE;
+    if (err) {
+        UnmapFile(&pack->file);
+        return err;
+    }
 
-            char ch = (cell->value && cell->value != ' ') ? cell->value : ' ';
-            printf("\x1b[%zu;%zuH%s%s%c%s|",
-                   i + 2, (size_t)(5 + j * 2),
-                   sel ? BG_WHITE : "",
-                   cell->isCommited ? YELLOW : (cell->isImmutable ? "" : RED),
-                   ch,
-                   RESET);
+    pack->size = h[5];
+    pack->recordLen = pack->size * pack->size / 4;
+    uint64_t count = 0;
+    for (int b = 7; b >= 0; b--) count = count << 8 | h[8 + b];
+    size_t sections = h[6] & PACK_HAS_SOLUTIONS ? 2 : 1;
+    if (count > (pack->file.len - PACK_HEADER_SIZE) / (pack->recordLen * sections)) {
+        UnmapFile(&pack->file);
+        return PACK_TRUNCATED;
+    }
+    pack->count = (size_t)count;
+    pack->puzzles = h + PACK_HEADER_SIZE;
+    if (sections == 2) pack->solutions = pack->puzzles + pack->count * pack->recordLen;
+    pack->path = strdup(path);
+    return 0;
+}
 
-            prev[idx].value = cell->value;
-            prev[idx].flags = flags;
-        }
+/* Message of a ReadLevel, OpenPack or errno error code */
+static const char *ReadErrorString(int err)
+{
+    switch (err) {
+    case -1:               return "truncated grid";
+    case -2:               return "the first line must have an even width, from 4 to 64";
+    case PACK_NOT_A_PACK:  return "not a .binpack file";
+    case PACK_BAD_VERSION: return "unsupported .binpack version";
+    case PACK_BAD_SIZE:    return "bad grid size in the .binpack header";
+    case PACK_TRUNCATED:   return "truncated .binpack file";
+    default:               return strerror(err);
     }
+}
 
-    /* Park cursor at message area */
-    printf("\x1b[%zu;1H", game->size + 3);
-    fflush(stdout);
+static inline unsigned PackedCell(const uint8_t *record, size_t k)
+{
+    return record[k / 4] >> (k % 4 * 2) & 3;
 }
 
-void moveSelection(Game* game, int dx, int dy)
+/* record must start zeroed */
+static inline void SetPackedCell(uint8_t *record, size_t k, char value)
 {
-    int row = (int)(game->selected / game->size);
-    int col = (int)(game->selected % game->size);
-    
-    if (dx < 0 && col > 0) col--;
+    unsigned code = value == '0' ? 1 : value == '1' ? 2 : 0;
+    record[k / 4] |= (uint8_t)(code << (k % 4 * 2));
+}
+
+/* record must hold size*size/4 bytes */
+static void PackGame(const Game *game, uint8_t *record)
+{
+    memset(record, 0, game->size * game->size / 4);
+    for (size_t k = 0; k < game->size * game->size; k++) SetPackedCell(record, k, game->array[k].value);
+}
+
+/* game must already have the pack's size */
+static void UnpackGame(const uint8_t *record, Game *game)
+{
+    for (size_t k = 0; k < game->size * game->size; k++) {
+        unsigned code = PackedCell(record, k);
+        game->array[k].value = code == 1 ? '0' : code == 2 ? '1' : ' ';
+        game->array[k].isImmutable = code == 1 || code == 2;
+        game->array[k].isCommited = 0;
+    }
+}
+
+typedef struct {
+    uint8_t *items;
+    size_t count;
+    size_t capacity;
+} Bytes;
+
+/* Append a zeroed record of len bytes and return it */
+static uint8_t *AppendRecord(Bytes *b, size_t len)
+{
+    if (b->count + len > b->capacity) {
+        b->capacity = b->capacity ? b->capacity : 4096;
+        while (b->count + len > b->capacity) b->capacity *= 2;
+        b->items = realloc(b->items, b->capacity);
+        if (!b->items) {
+            perror("realloc");
+            exit(EXIT_FAILURE);
+        }
+    }
+    uint8_t *record = b->items + b->count;
+    memset(record, 0, len);
+    b->count += len;
+    return record;
+}
+
+/* solutions: NULL, or as many records as puzzles. Returns 0 or an errno value. */
+static int WritePack(const char *path, size_t size, const Bytes *puzzles, const Bytes *solutions)
+{
+    FILE *f = fopen(path, "wb");
+    if (!f) return errno;
+    uint64_t count = puzzles->count / (size * size / 4);
+    uint8_t h[PACK_HEADER_SIZE] = { 'B', 'N', 'R', 'P', PACK_VERSION, (uint8_t)size,
+                                    solutions ? PACK_HAS_SOLUTIONS : 0, 0 };
+    for (int b = 0; b < 8; b++) h[8 + b] = (uint8_t)(count >> (8 * b));
+    fwrite(h, 1, sizeof(h), f);
+    if (puzzles->count) fwrite(puzzles->items, 1, puzzles->count, f);
+    if (solutions && solutions->count) fwrite(solutions->items, 1, solutions->count, f);
+    int err = ferror(f) ? EIO : 0;
+    if (fclose(f) != 0 && !err) err = errno;
+    return err;
+}
+
+/*
+Cell* GetCellPtr(Game *game, size_t i, size_t j)
+{
+    if(LIKELY(i<game->size && j<game->size))
+        return &game->array[i * game->size + j];
+    return 0;
+}
+*/
+
+
+/* a-z, then A-Z and digits: one character per column up to 64 columns */
+static char ColumnLabel(size_t j)
+{
+    static const char labels[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789+-";
+    return j < sizeof(labels) - 1 ? labels[j] : '?';
+}
+
+/* A frame of terminal output, built in memory and written at once */
+typedef struct {
+    char *items;
+    size_t count;
+    size_t capacity;
+} Frame;
+
+static void FrameAppend(Frame *f, const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(f->items ? f->items + f->count : NULL, f->capacity - f->count, fmt, ap);
+    va_end(ap);
+    if (n < 0) return;
+    if (f->count + (size_t)n >= f->capacity) {
+        while (f->count + (size_t)n >= f->capacity)
+            f->capacity = f->capacity ? f->capacity * 2 : 4096;
+        f->items = realloc(f->items, f->capacity);
+        if (!f->items) {
+            perror("realloc");
+            exit(EXIT_FAILURE);
+        }
+        va_start(ap, fmt);
+        vsnprintf(f->items + f->count, f->capacity - f->count, fmt, ap);
+        va_end(ap);
+    }
+    f->count += (size_t)n;
+}
+
+/* One write for the whole frame, after anything stdio still holds */
+static void FrameFlush(Frame *f)
+{
+    fflush(stdout);
+    const char *p = f->items;
+    size_t left = f->count;
+    while (left) {
+#ifdef _WIN32
+        int n = _write(1, p, left > 1u << 30 ? 1u << 30 : (unsigned)left);
+#else
+        ssize_t n = write(STDOUT_FILENO, p, left);
+        if (n < 0 && errno == EINTR) continue;
+#endif
+        if (n <= 0) break;
+        p += n;
+        left -= (size_t)n;
+    }
+    f->count = 0;
+}
+
+void PrintGame(Game* game)
+{
+    /* Per-cell render state for differential updates */
+    typedef struct { char value; unsigned char flags; } RState;
+    static RState *prev = NULL;
+    static size_t prev_size = 0;
+    static Frame frame = {0};
+
+    size_t total = game->size * game->size;
+    int full_redraw = g_force_redraw || !prev || prev_size != game->size;
+
+    if (full_redraw) {
+        free(prev);
+        prev = malloc(total * sizeof(*prev));
+        memset(prev, 0xFF, total * sizeof(*prev)); /* force every cell diff */
+        prev_size = game->size;
+        g_force_redraw = 0;
+
+        /* Clear screen and draw static parts */
+        FrameAppend(&frame, "\x1b[H\x1b[2J\x1b[3J\x1b[?25l");
+
+        /* Header at row 1 */
+        FrameAppend(&frame, "\x1b[1;1H   ");
+        for (size_t j = 0; j < game->size; j++)
+            FrameAppend(&frame, " %c", ColumnLabel(j));
+
+        /* Footer */
+        FrameAppend(&frame, "\x1b[%zu;1H" "Fleches: nav|'a'/'e'->'0'/'1'|'r'emove | 'c'ommit | 'x'port | 'q'uit",
+                    game->size + 2);
+    }
+
+    /* Update only changed cells. Drawing a cell leaves the cursor on the next one, so a run of
+       changed cells needs a single move; on a full redraw the row label is the move. */
+    size_t row = 0, col = 0; /* terminal cursor, 0 when unknown */
+    for (size_t i = 0; i < game->size; i++) {
+        if (full_redraw) {
+            FrameAppend(&frame, "\x1b[%zu;1H%2zu:|", i + 2, i + 1);
+            row = i + 2;
+            col = 5;
+        }
+        for (size_t j = 0; j < game->size; j++) {
+            size_t idx = i * game->size + j;
+            Cell *cell = &game->array[idx];
+            unsigned char sel = (idx == game->selected) ? 1 : 0;
+            unsigned char flags = (unsigned char)(
+                (cell->isImmutable ? 1u : 0u) |
+                (cell->isCommited  ? 2u : 0u) |
+                (sel               ? 4u : 0u));
+
+            if (prev[idx].value == cell->value && prev[idx].flags == flags)
+                continue;
+
+            if (row != i + 2 || col != 5 + j * 2)
+                FrameAppend(&frame, "\x1b[%zu;%zuH", i + 2, (size_t)(5 + j * 2));
+            char ch = (cell->value && cell->value != ' ') ? cell->value : ' ';
+            FrameAppend(&frame, "%s%s%c%s|",
+                        sel ? BG_WHITE : "",
+                        cell->isCommited ? YELLOW : (cell->isImmutable ? "" : RED),
+                        ch,
+                        RESET);
+            row = i + 2;
+            col = 7 + j * 2;
+
+            prev[idx].value = cell->value;
+            prev[idx].flags = flags;
+        }
+    }
+
+    /* Message area (2 lines), then park the cursor there */
+    const char *second = strchr(g_message, '\n');
+    int len = second ? (int)(second - g_message) : (int)strlen(g_message);
+    FrameAppend(&frame, "\x1b[%zu;1H\x1b[2K%.*s\x1b[%zu;1H\x1b[2K%s\x1b[%zu;1H",
+                game->size + 3, len, g_message, game->size + 4, second ? second + 1 : "",
+                game->size + 3);
+    g_message[0] = '\0';
+    FrameFlush(&frame);
+}
+
+/* Sets the message of the next frame */
+void ShowMessage(const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(g_message, sizeof(g_message), fmt, ap);
+    va_end(ap);
+}
+
+void moveSelection(Game* game, int dx, int dy)
+{
+    int row = (int)(game->selected / game->size);
+    int col = (int)(game->selected % game->size);
+    
+    if (dx < 0 && col > 0) col--;
     else if (dx > 0 && col < (int)game->size - 1) col++;
     if (dy < 0 && row > 0) row--;
     else if (dy > 0 && row < (int)game->size - 1) row++;
@@ -396,7 +1159,7 @@ size_t QuotaExhaustedRule(Game* game)
         for (size_t i = 0; i < game->size; i++)
         {
             size_t n0 = 0, n1 = 0;
-            size_t* indices = alloca(game->size/2 * sizeof(size_t));
+            size_t indices[BIT_MAX_SIZE / 2];
             size_t add_idx = 0;
             for (size_t j = 0; j < game->size; j++)
             {
@@ -436,322 +1199,3297 @@ size_t QuotaExhaustedRule(Game* game)
     return somethingChangedHere;
 }
 
-void EvidentSolve(Game* game)
+static inline Line FullLine(size_t size)
 {
-    Rule rules[] = { AdjacentPairRule, QuotaExhaustedRule, NULL };
+    return size >= BIT_MAX_SIZE ? ~(Line)0 : ((Line)1 << size) - 1;
+}
 
-    size_t somethingChanged;
-    do {
-        somethingChanged = 0;
-        for (size_t i = 0; rules[i] != NULL; ++i) {
-            somethingChanged |= rules[i](game);
-        }
-    } while (LIKELY(somethingChanged));
-    
+static Propagator PropagatorFor(size_t size);
+static PatternScan PatternScanFor(void);
+
+/* Zobrist keys are drawn from a hash of their index rather than a table */
+static inline uint64_t ZobristMix(uint64_t x)
+{
+    uint64_t z = (x + 1) * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
 }
 
-Game CloneGame(const Game *src)
+static inline uint64_t ZobristCell(TrailEntry e)
 {
-    Game g = { .size = src->size, .array = malloc(src->size * src->size * sizeof(Cell)), .selected = 0 };
-    if (!g.array) { perror("malloc"); exit(EXIT_FAILURE); }
-    memcpy(g.array, src->array, src->size * src->size * sizeof(Cell));
-    return g;
+    return ZobristMix((uint64_t)e.i << 7 | (uint64_t)e.j << 1 | e.v);
 }
 
-size_t checkWin(Game* game)
+/* An empty bitboard, allocated in `arena` or, when it is NULL, on the heap */
+BitGame InitBitGame(Arena *arena, size_t size)
 {
-    // Check if all cells are filled
-    for (size_t i = 0; i < game->size * game->size; i++)
-    {
-        if (game->array[i].value == ' ' || game->array[i].value == 0)
-        {
-            if(PrintAndDebug)
-                printf("Cell %zu is empty\n", i);
-            return NOT_FINISHED;
+    BitGame bg = { .size = size, .full = FullLine(size), .propagate = PropagatorFor(size), .scan = PatternScanFor(),
+                   .inArena = arena != NULL, .hash = ZobristMix((uint64_t)size << 13) };
+    /* The sets of complete lines stay at most half full */
+    size_t slots = 4;
+    while (slots < 2 * size) slots <<= 1;
+    bg.seenMask = slots - 1;
+    size_t count = 4 * size + 2 * slots;
+    Line *lines;
+    /* A cell is written at most once between two rollbacks */
+    if (arena) {
+        lines = ArenaAlloc(arena, count * sizeof(Line));
+        memset(lines, 0, count * sizeof(Line));
+        bg.trail = ArenaAlloc(arena, size * size * sizeof(TrailEntry));
+    }
+    else {
+        lines = calloc(count, sizeof(Line));
+        bg.trail = malloc(size * size * sizeof(TrailEntry));
+        if (!lines || !bg.trail) {
+            perror("malloc");
+            exit(EXIT_FAILURE);
         }
     }
+    bg.rows[0] = lines;
+    bg.rows[1] = lines + size;
+    bg.cols[0] = lines + 2 * size;
+    bg.cols[1] = lines + 3 * size;
+    bg.seen[0] = lines + 4 * size;
+    bg.seen[1] = lines + 4 * size + slots;
+    return bg;
+}
 
-    for (size_t dir = 0; dir < 2; dir++)
-    {
-        for (size_t i = 0; i < game->size; i++)
-        {
-            size_t count0 = 0, count1 = 0;
-
-            for (size_t j = 0; j < game->size; j++)
-            {
-                size_t idx = dir == 0 ? i * game->size + j : j * game->size + i;
-                if (game->array[idx].value == '0') count0++;
-                else if (game->array[idx].value == '1') count1++;
-
-                // Check for three consecutive identical values
-                if (j >= 2)
-                {
-                    size_t idx1 = dir == 0 ? i * game->size + (j-2) : (j-2) * game->size + i;
-                    size_t idx2 = dir == 0 ? i * game->size + (j-1) : (j-1) * game->size + i;
-                    if (game->array[idx1].value == game->array[idx2].value &&
-                        game->array[idx2].value == game->array[idx].value)
-                    {
-                        if(PrintAndDebug)
-                            printf("%s %zu has three consecutive '%c'\n",
-                                dir == 0 ? "Row" : "Column", i, game->array[idx].value);
-                        return IMPOSSIBLE;
-                    }
-                }
-            }
+BitGame CloneBitGame(const BitGame *src)
+{
+    BitGame bg = InitBitGame(NULL, src->size);
+    memcpy(bg.rows[0], src->rows[0], (4 * src->size + 2 * (src->seenMask + 1)) * sizeof(Line));
+    memcpy(bg.trail, src->trail, src->trailLen * sizeof(TrailEntry));
+    bg.trailLen = src->trailLen;
+    bg.hash = src->hash;
+    for (int d = 0; d < 2; d++) {
+        bg.dirty[d] = src->dirty[d];
+        bg.complete[d] = src->complete[d];
+        bg.broken[d] = src->broken[d];
+    }
+    return bg;
+}
 
-            if (count0 != game->size / 2 || count1 != game->size / 2)
-            {
-                if(PrintAndDebug)
-                    printf("%s %zu does not have equal 0s and 1s\n", dir == 0 ? "Row" : "Column", i);
-                return IMPOSSIBLE;
-            }
-            else if (count0 + count1 != game->size)
-            {
-                if(PrintAndDebug)
-                    printf("%s %zu has empty cells\n", dir == 0 ? "Row" : "Column", i);
-                return NOT_FINISHED;
-            }
+void FreeBitGame(BitGame *bg)
+{
+    if (!bg) return;
+    if (!bg->inArena) {
+        free(bg->rows[0]);
+        free(bg->trail);
+    }
+    memset(bg, 0, sizeof(*bg));
+}
 
-            // Check uniqueness against all subsequent rows/columns
-            for (size_t i2 = i + 1; i2 < game->size; i2++)
-            {
-                size_t identical = 1;
-                for (size_t j = 0; j < game->size; j++)
-                {
-                    size_t idx1 = dir == 0 ? i * game->size + j : j * game->size + i;
-                    size_t idx2 = dir == 0 ? i2 * game->size + j : j * game->size + i2;
-                    if (game->array[idx1].value != game->array[idx2].value)
-                    {
-                        identical = 0;
-                        break;
-                    }
-                }
-                if (identical)
-                {
-                    if(PrintAndDebug)
-                        printf("%s %zu and %zu are identical\n", dir == 0 ? "Rows" : "Columns", i, i2);
-                    return IMPOSSIBLE;
-                }
-            }
-        }
+static inline void debugCheckLine(const BitGame *bg, int dir, size_t i, int v, Line bits, const char *ruleName)
+{
+    if (!PrintAndDebug || !g_solution) return;
+    for (; bits; bits &= bits - 1) {
+        size_t j = (size_t)__builtin_ctzll(bits);
+        size_t idx = dir == 0 ? i * bg->size + j : j * bg->size + i;
+        if (g_solution[idx] != '0' + v)
+            printf("\x1b[31m[BUG] %s: cell (%zu,%zu) set to '%c' but solution expects '%c'\x1b[0m\n",
+                   ruleName, idx / bg->size, idx % bg->size, '0' + v, g_solution[idx]);
     }
-    return WIN;
 }
 
-void Solve(Game* game)
+static inline size_t SeenSlot(const BitGame *bg, Line ones)
 {
-    // Make a copy to work on
-    Game myGame = CloneGame(game);
-    EvidentSolve(&myGame);
+    return (size_t)((ones * 0x9E3779B97F4A7C15ull) >> 40) & bg->seenMask;
+}
 
-    // Get Every empty cell idx and make a DA of it
-    Indexes emptyCells = {0};
-    for (size_t i = 0; i < myGame.size * myGame.size; i++) {
-        if (myGame.array[i].value == ' ' || myGame.array[i].value == 0) {
-            da_append(&emptyCells, (int)i);
+/* Line i just got its last cell: check it once here, so that the grid is known valid or not
+   without rescanning it. A valid line joins the set of complete lines, where a twin is a
+   single lookup away. */
+static inline void BitLineCompleted(BitGame *bg, int dir, size_t i)
+{
+    Line *const *lines = dir == 0 ? bg->rows : bg->cols;
+    Line z = lines[0][i], o = lines[1][i];
+    if ((z & z >> 1 & z >> 2) | (o & o >> 1 & o >> 2)
+        || (size_t)__builtin_popcountll(o) != bg->size / 2) {
+        bg->broken[dir] |= (Line)1 << i;
+        return;
+    }
+    Line *seen = bg->seen[dir];
+    size_t slot = SeenSlot(bg, o);
+    for (; seen[slot]; slot = (slot + 1) & bg->seenMask) {
+        if (seen[slot] == o) {
+            bg->broken[dir] |= (Line)1 << i;
+            return;
         }
     }
+    seen[slot] = o;
+}
 
-
-    // If EvidentSolve already solved it, copy back and return
-    if (emptyCells.count == 0) {
-        if (checkWin(&myGame) == WIN) {
-            memcpy(game->array, myGame.array, myGame.size * myGame.size * sizeof(Cell));
+/* Line i is about to lose a cell: undo BitLineCompleted. Rollbacks are last in, first out, so
+   a line broken by a twin always reopens before its twin does. */
+static inline void BitLineReopened(BitGame *bg, int dir, size_t i)
+{
+    if (bg->broken[dir] >> i & 1) {
+        bg->broken[dir] &= ~((Line)1 << i);
+        return;
+    }
+    Line o = (dir == 0 ? bg->rows : bg->cols)[1][i];
+    Line *seen = bg->seen[dir];
+    size_t mask = bg->seenMask;
+    size_t hole = SeenSlot(bg, o);
+    while (seen[hole] != o) hole = (hole + 1) & mask;
+    /* Backward shift: pull back every later entry of the run that may sit in the hole */
+    for (size_t next = (hole + 1) & mask; seen[next]; next = (next + 1) & mask) {
+        size_t home = SeenSlot(bg, seen[next]);
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            seen[hole] = seen[next];
+            hole = next;
         }
-        goto cleanup;
     }
+    seen[hole] = 0;
+}
 
-    // Try '0' and '1' on the first empty cell and recurse
-    else
-    {
-        size_t idx = (size_t)emptyCells.items[0];
-        for (char val = '0'; val <= '1'; val++) {
-            Game tryGame = CloneGame(&myGame);
-            tryGame.array[idx].value = val;
-            Solve(&tryGame);
-            if (checkWin(&tryGame) == WIN) {
-                memcpy(game->array, tryGame.array, tryGame.size * tryGame.size * sizeof(Cell));
-                FreeGame(&tryGame);
-                goto cleanup;
-            }
-            FreeGame(&tryGame);
+/* Set `bits` of line i (dir 0 = row, dir 1 = column) to v, mirror them in the transposed
+   lines, enqueue every line that was touched and record the cells on the trail */
+static inline void BitSetLine(BitGame *bg, int dir, size_t i, int v, Line bits)
+{
+    Line *const *mine  = dir == 0 ? bg->rows : bg->cols;
+    Line *const *other = dir == 0 ? bg->cols : bg->rows;
+    Line wasComplete[2] = { bg->complete[0], bg->complete[1] };
+    mine[v][i] |= bits;
+    bg->dirty[dir] |= (Line)1 << i;
+    bg->dirty[!dir] |= bits;
+    if ((mine[0][i] | mine[1][i]) == bg->full && !(bg->complete[dir] >> i & 1)) {
+        bg->complete[dir] |= (Line)1 << i;
+        BitLineCompleted(bg, dir, i);
+    }
+    for (; bits; bits &= bits - 1) {
+        size_t j = (size_t)__builtin_ctzll(bits);
+        other[v][j] |= (Line)1 << i;
+        if ((other[0][j] | other[1][j]) == bg->full) {
+            bg->complete[!dir] |= (Line)1 << j;
+            BitLineCompleted(bg, !dir, j);
         }
+        TrailEntry e = dir == 0
+            ? (TrailEntry){ (uint8_t)i, (uint8_t)j, (uint8_t)v, bg->why }
+            : (TrailEntry){ (uint8_t)j, (uint8_t)i, (uint8_t)v, bg->why };
+        bg->trail[bg->trailLen++] = e;
+        bg->hash ^= ZobristCell(e);
     }
-cleanup:
-    free(emptyCells.items);
-    FreeGame(&myGame);
+    /* A line just completed is a new uniqueness constraint for every open line parallel to it */
+    for (int d = 0; d < 2; d++)
+        if (bg->complete[d] != wasComplete[d])
+            bg->dirty[d] |= bg->full & ~bg->complete[d];
 }
 
-void ExportLevel(Game *game)
+static inline Line BitEmpty(const BitGame *bg, int dir, size_t i)
 {
-    /* Temporarily disable raw mode to read filename */
-    disableRawMode();
-    printf("\nNom du niveau (sans extension): ");
-    fflush(stdout);
-
-    char name[128] = {0};
-    if (fgets(name, sizeof(name), stdin) == NULL || name[0] == '\n') {
-        printf("Export annulé.\n");
-        enableRawMode();
-        return;
-    }
-    /* Strip trailing newline */
-    name[strcspn(name, "\n")] = '\0';
+    Line *const *lines = dir == 0 ? bg->rows : bg->cols;
+    return bg->full & ~(lines[0][i] | lines[1][i]);
+}
 
-    char path[256];
-    snprintf(path, sizeof(path), "levels/%s.binero", name);
+static inline void BitSetCell(BitGame *bg, size_t idx, int v)
+{
+    BitSetLine(bg, 0, idx / bg->size, v, (Line)1 << (idx % bg->size));
+}
 
-    FILE *f = fopen(path, "wb");
-    if (!f) {
-        printf("Erreur: %s\n", strerror(errno));
-        enableRawMode();
-        return;
+/* Erase every cell written after the trail had `mark` entries. The state at the mark was
+   fully propagated, so the queues are emptied as well. */
+static inline void BitUndo(BitGame *bg, size_t mark)
+{
+    while (bg->trailLen > mark) {
+        TrailEntry e = bg->trail[--bg->trailLen];
+        bg->hash ^= ZobristCell(e);
+        if (UNLIKELY(bg->complete[0] >> e.i & 1)) BitLineReopened(bg, 0, e.i);
+        if (UNLIKELY(bg->complete[1] >> e.j & 1)) BitLineReopened(bg, 1, e.j);
+        bg->rows[e.v][e.i] &= ~((Line)1 << e.j);
+        bg->cols[e.v][e.j] &= ~((Line)1 << e.i);
+        bg->complete[0] &= ~((Line)1 << e.i);
+        bg->complete[1] &= ~((Line)1 << e.j);
     }
+    if (bg->watched > mark) bg->watched = mark;
+    bg->dirty[0] = bg->dirty[1] = 0;
+}
+
+BitGame BitFromGame(Arena *arena, const Game *game)
+{
+    BitGame bg = InitBitGame(arena, game->size);
     for (size_t i = 0; i < game->size; i++) {
         for (size_t j = 0; j < game->size; j++) {
             char v = game->array[i * game->size + j].value;
-            fputc((v == '0' || v == '1') ? v : ' ', f);
+            if (v == '0' || v == '1')
+                BitSetLine(&bg, 0, i, v - '0', (Line)1 << j);
         }
-        if (i < game->size - 1) fputc('\n', f);
     }
-    fclose(f);
-    printf("Exporté vers %s\n", path);
-    enableRawMode();
-    g_force_redraw = 1;
+    return bg;
 }
 
-Game SelectLevel(void)
+/* Write back every value the bitboard knows into the still-empty cells of game */
+void BitToGame(const BitGame *bg, Game *game)
 {
-    /* Scan levels/ directory for .binero files */
-    const char *levelsDir = "levels";
-    char paths[64][256];
-    size_t count = 0;
+    for (size_t i = 0; i < bg->size; i++) {
+        for (int v = 0; v < 2; v++) {
+            for (Line bits = bg->rows[v][i]; bits; bits &= bits - 1) {
+                Cell *cell = &game->array[i * game->size + (size_t)__builtin_ctzll(bits)];
+                if (cell->value == ' ' || cell->value == 0)
+                    cell->value = (char)('0' + v);
+            }
+        }
+    }
+}
 
-#ifdef _WIN32
-    char pattern[280];
-    snprintf(pattern, sizeof(pattern), "%s\\*.binero", levelsDir);
+/* Line rules: deduce the cells of line i (dir 0 = row, dir 1 = column) that are forced to 0 / to 1.
+   `size` is bg->size, passed along so that the sized propagators see it as a constant. */
+
+/* TwoEqualsThree and FillTheHole on a whole line: empty cells next to, or between, two equal values */
+static inline int LineAdjacentPair(const BitGame *bg, size_t size, int dir, size_t i, Line *force0, Line *force1)
+{
+    Line *const *lines = dir == 0 ? bg->rows : bg->cols;
+    Line zeros = lines[0][i], ones = lines[1][i];
+    if (UNLIKELY((zeros & zeros >> 1 & zeros >> 2) | (ones & ones >> 1 & ones >> 2)))
+        return CONFLICT;
+    Line empty = FullLine(size) & ~(zeros | ones);
+    *force1 = empty & ((zeros << 1 & zeros << 2) | (zeros >> 1 & zeros >> 2) | (zeros << 1 & zeros >> 1));
+    *force0 = empty & ((ones << 1 & ones << 2) | (ones >> 1 & ones >> 2) | (ones << 1 & ones >> 1));
+    return NOT_FINISHED;
+}
+
+static inline int LineQuotaExhausted(const BitGame *bg, size_t size, int dir, size_t i, Line *force0, Line *force1)
+{
+    Line *const *lines = dir == 0 ? bg->rows : bg->cols;
+    size_t half = size / 2;
+    size_t n0 = (size_t)__builtin_popcountll(lines[0][i]);
+    size_t n1 = (size_t)__builtin_popcountll(lines[1][i]);
+    if (UNLIKELY(n0 > half || n1 > half)) return CONFLICT;
+    Line empty = FullLine(size) & ~(lines[0][i] | lines[1][i]);
+    *force1 = n0 == half ? empty : 0;
+    *force0 = n1 == half ? empty : 0;
+    return NOT_FINISHED;
+}
+
+/* Rule 3 on a nearly full line: when only one 0 (or one 1) is left to place, it cannot go where
+   a complete parallel line matching the filled cells has it, or the line would be a copy */
+static inline int LineUniqueness(const BitGame *bg, size_t size, int dir, size_t i, Line *force0, Line *force1)
+{
+    *force0 = *force1 = 0;
+    Line *const *lines = dir == 0 ? bg->rows : bg->cols;
+    Line zeros = lines[0][i], ones = lines[1][i];
+    Line empty = FullLine(size) & ~(zeros | ones);
+    size_t half = size / 2;
+    size_t n0 = (size_t)__builtin_popcountll(zeros);
+    size_t n1 = (size_t)__builtin_popcountll(ones);
+    if (!empty || (n0 + 1 != half && n1 + 1 != half)) return NOT_FINISHED;
+
+    for (Line c = bg->complete[dir]; c; c &= c - 1) {
+        Line t = lines[1][__builtin_ctzll(c)];
+        if ((t & zeros) || (t & ones) != ones) continue;
+        if (n1 + 1 == half) *force0 |= empty & t;
+        if (n0 + 1 == half) *force1 |= empty & ~t;
+    }
+    return NOT_FINISHED;
+}
+
+/* Every valid full line of a given size (balanced, no triple) as its ones mask, built on first
+   use. Above PATTERN_MAX_SIZE the tables outgrow the cache and LineReach takes over. */
+#define PATTERN_MAX_SIZE 16
+
+typedef struct {
+    Line *items;
+    size_t count;
+    size_t capacity;
+} LineTable;
+
+static LineTable g_lineTables[PATTERN_MAX_SIZE + 1];
+static atomic_int g_lineTablesReady[PATTERN_MAX_SIZE + 1];
+static Mutex g_lineTablesLock = MUTEX_INIT;
+
+static void BuildLineTable(LineTable *table, size_t size, size_t pos, Line ones, size_t n0, size_t n1)
+{
+    if (pos == size) {
+        da_append(table, ones);
+        return;
+    }
+    for (int v = 0; v <= 1; v++) {
+        if ((v ? n1 : n0) == size / 2) continue;
+        Line same = v ? ones : ~ones;
+        if (pos >= 2 && (same >> (pos - 1) & 1) && (same >> (pos - 2) & 1)) continue;
+        BuildLineTable(table, size, pos + 1, v ? ones | (Line)1 << pos : ones, n0 + !v, n1 + v);
+    }
+}
+
+static const LineTable *GetLineTable(size_t size)
+{
+    if (size > PATTERN_MAX_SIZE) return NULL;
+    LineTable *table = &g_lineTables[size];
+    if (UNLIKELY(!atomic_load_explicit(&g_lineTablesReady[size], memory_order_acquire))) {
+        MutexLock(&g_lineTablesLock);
+        if (!table->count) BuildLineTable(table, size, 0, 0, 0, 0);
+        atomic_store_explicit(&g_lineTablesReady[size], 1, memory_order_release);
+        MutexUnlock(&g_lineTablesLock);
+    }
+    return table;
+}
+
+/* The pattern intersection for lines too long for a table, copies of complete lines aside: a
+   forward then backward pass over (ones so far, last value, run length) states, each set of
+   reachable ones counts kept as a mask. A value is possible in a cell if a state holding it
+   there is both reachable from the start and able to reach a balanced end. */
+static int LineReach(size_t size, Line zeros, Line ones, Line *force0, Line *force1)
+{
+    size_t half = size / 2;
+    Line fwd[BIT_MAX_SIZE][2][2], bwd[BIT_MAX_SIZE][2][2]; /* [position][value][run length - 1] */
+    Line counts[BIT_MAX_SIZE];
+
+    for (size_t p = 0; p < size; p++) {
+        /* after p: at most half ones, and enough of them for the zeros to fit */
+        Line low = p + 1 > half ? ((Line)1 << (p + 1 - half)) - 1 : 0;
+        counts[p] = (((Line)2 << half) - 1) & ~low;
+        for (int w = 0; w < 2; w++) {
+            if ((w ? zeros : ones) >> p & 1) {
+                fwd[p][w][0] = fwd[p][w][1] = 0;
+                continue;
+            }
+            if (p == 0) {
+                fwd[p][w][0] = (Line)w << w | (Line)!w;
+                fwd[p][w][1] = 0;
+                continue;
+            }
+            fwd[p][w][0] = ((fwd[p - 1][!w][0] | fwd[p - 1][!w][1]) << w) & counts[p];
+            fwd[p][w][1] = (fwd[p - 1][w][0] << w) & counts[p];
+        }
+    }
+
+    for (size_t p = size; p-- > 0;) {
+        for (int v = 0; v < 2; v++) {
+            for (int r = 0; r < 2; r++) {
+                if (p == size - 1) {
+                    bwd[p][v][r] = (Line)1 << half;
+                    continue;
+                }
+                Line m = 0;
+                for (int w = 0; w < 2; w++) {
+                    if ((w ? zeros : ones) >> (p + 1) & 1) continue;
+                    if (w != v) m |= bwd[p + 1][w][0] >> w;
+                    else if (r == 0) m |= bwd[p + 1][w][1] >> w;
+                }
+                bwd[p][v][r] = m & counts[p];
+            }
+        }
+    }
+
+    Line can[2] = { 0, 0 };
+    for (size_t p = 0; p < size; p++)
+        for (int w = 0; w < 2; w++)
+            if ((fwd[p][w][0] & bwd[p][w][0]) | (fwd[p][w][1] & bwd[p][w][1]))
+                can[w] |= (Line)1 << p;
+    Line full = FullLine(size);
+    if (UNLIKELY((can[0] | can[1]) != full)) return CONFLICT;
+    Line empty = full & ~(zeros | ones);
+    *force1 = empty & ~can[0];
+    *force0 = empty & ~can[1];
+    return NOT_FINISHED;
+}
+
+static inline void KeepPattern(Line p, const Line *twins, size_t twinCount, Line *all, Line *any, size_t *kept)
+{
+    size_t t = 0;
+    while (t < twinCount && twins[t] != p) t++;
+    if (t < twinCount) return;
+    *all &= p;
+    *any |= p;
+    (*kept)++;
+}
+
+static size_t PatternScanScalar(const Line *items, size_t count, Line zeros, Line ones,
+                                const Line *twins, size_t twinCount, Line *all, Line *any)
+{
+    size_t kept = 0;
+    for (size_t k = 0; k < count; k++) {
+        Line p = items[k];
+        if ((p & zeros) | (ones & ~p)) continue;
+        KeepPattern(p, twins, twinCount, all, any, &kept);
+    }
+    return kept;
+}
+
+#ifdef HAVE_X86_SIMD
+/* Most candidates are rejected, so test 2 (SSE2) or 4 (AVX2) at once and only look at the
+   matching ones one by one */
+__attribute__((target("sse2")))
+static size_t PatternScanSse2(const Line *items, size_t count, Line zeros, Line ones,
+                              const Line *twins, size_t twinCount, Line *all, Line *any)
+{
+    __m128i z = _mm_set1_epi64x((long long)zeros), o = _mm_set1_epi64x((long long)ones);
+    size_t kept = 0, k = 0;
+    for (; k + 2 <= count; k += 2) {
+        __m128i p = _mm_loadu_si128((const __m128i *)(items + k));
+        __m128i miss = _mm_or_si128(_mm_and_si128(p, z), _mm_andnot_si128(p, o));
+        /* no 64-bit compare in SSE2: a lane matches when both of its 32-bit halves are zero */
+        int m = _mm_movemask_epi8(_mm_cmpeq_epi32(miss, _mm_setzero_si128()));
+        if (LIKELY(!m)) continue;
+        if ((m & 0x00FF) == 0x00FF) KeepPattern(items[k], twins, twinCount, all, any, &kept);
+        if ((m & 0xFF00) == 0xFF00) KeepPattern(items[k + 1], twins, twinCount, all, any, &kept);
+    }
+    return kept + PatternScanScalar(items + k, count - k, zeros, ones, twins, twinCount, all, any);
+}
+
+__attribute__((target("avx2")))
+static size_t PatternScanAvx2(const Line *items, size_t count, Line zeros, Line ones,
+                              const Line *twins, size_t twinCount, Line *all, Line *any)
+{
+    __m256i z = _mm256_set1_epi64x((long long)zeros), o = _mm256_set1_epi64x((long long)ones);
+    size_t kept = 0, k = 0;
+    for (; k + 4 <= count; k += 4) {
+        __m256i p = _mm256_loadu_si256((const __m256i *)(items + k));
+        __m256i miss = _mm256_or_si256(_mm256_and_si256(p, z), _mm256_andnot_si256(p, o));
+        int m = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(miss, _mm256_setzero_si256())));
+        for (; m; m &= m - 1)
+            KeepPattern(items[k + (size_t)__builtin_ctz((unsigned)m)], twins, twinCount, all, any, &kept);
+    }
+    return kept + PatternScanScalar(items + k, count - k, zeros, ones, twins, twinCount, all, any);
+}
+#endif
+
+/* Widest kernel the CPU runs, the scalar one elsewhere */
+static PatternScan PatternScanFor(void)
+{
+#ifdef HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return PatternScanAvx2;
+    if (__builtin_cpu_supports("sse2")) return PatternScanSse2;
+#endif
+    return PatternScanScalar;
+}
+
+/* Intersect every valid completion of the line that is not a copy of a complete parallel line:
+   the cells on which all of them agree are forced */
+static inline int LinePatterns(const BitGame *bg, size_t size, int dir, size_t i, Line *force0, Line *force1)
+{
+    *force0 = *force1 = 0;
+    Line *const *lines = dir == 0 ? bg->rows : bg->cols;
+    Line zeros = lines[0][i], ones = lines[1][i];
+    Line full = FullLine(size), empty = full & ~(zeros | ones);
+    if (!empty) return NOT_FINISHED;
+    if (size > PATTERN_MAX_SIZE) return LineReach(size, zeros, ones, force0, force1);
+    const LineTable *table = GetLineTable(size);
+
+    /* Only the complete lines matching the partial one can rule out a candidate */
+    Line twins[BIT_MAX_SIZE];
+    size_t twinCount = 0;
+    for (Line c = bg->complete[dir]; c; c &= c - 1) {
+        Line t = lines[1][__builtin_ctzll(c)];
+        if (!(t & zeros) && (t & ones) == ones) twins[twinCount++] = t;
+    }
+
+    Line all = full, any = 0;
+    size_t survivors = bg->scan(table->items, table->count, zeros, ones, twins, twinCount, &all, &any);
+    if (UNLIKELY(!survivors)) return CONFLICT;
+    *force1 = empty & all;
+    *force0 = empty & ~any;
+    return NOT_FINISHED;
+}
+
+/* Line i (dir 0 = row, dir 1 = column) as the reason of a write or a conflict, see WHY_SET */
+static inline TrailEntry LineReason(int dir, size_t i, uint8_t wide)
+{
+    return dir == 0 ? (TrailEntry){ (uint8_t)i, 0, 0, (uint8_t)(WHY_ROW | wide) }
+                    : (TrailEntry){ 0, (uint8_t)i, 0, (uint8_t)(WHY_COL | wide) };
+}
+
+/* Run the line rules on dirty lines only, until no line is left in the queue.
+   Returns CONFLICT as soon as a line is invalid or a cell is forced both ways (the queues
+   are then dropped, the caller is expected to roll back), NOT_FINISHED otherwise.
+   Always inlined into the propagators below, with `size` a constant for the common sizes. */
+static inline __attribute__((always_inline)) size_t BitPropagateSized(BitGame *bg, size_t size)
+{
+    /* Counted in registers, stored once per call */
+    size_t calls[LINE_RULE_COUNT] = {0}, cells[LINE_RULE_COUNT] = {0};
+    size_t status = NOT_FINISHED;
+    bg->prop.passes++;
+    while (bg->dirty[0] | bg->dirty[1]) {
+        int dir = bg->dirty[0] ? 0 : 1;
+        size_t i = (size_t)__builtin_ctzll(bg->dirty[dir]);
+        bg->dirty[dir] &= bg->dirty[dir] - 1;
+        /* Any write re-queues a line, so a line broken by the last one is caught here */
+        if (UNLIKELY(bg->broken[0] | bg->broken[1])) {
+            int bad = bg->broken[0] ? 0 : 1;
+            bg->conflict = LineReason(bad, (size_t)__builtin_ctzll(bg->broken[bad]), WHY_WIDE);
+            bg->dirty[0] = bg->dirty[1] = 0;
+            status = CONFLICT;
+            goto done;
+        }
+
+        size_t rule = 0; /* a constant in each unrolled step */
+        do {
+#define TRY_LINE_RULE(kernel, name, wide)                                           \
+            {                                                                       \
+                Line force0, force1;                                                \
+                calls[rule]++;                                                      \
+                if (UNLIKELY(kernel(bg, size, dir, i, &force0, &force1) == CONFLICT \
+                             || (force0 & force1))) {                               \
+                    bg->conflict = LineReason(dir, i, wide ? WHY_WIDE : 0);         \
+                    bg->dirty[0] = bg->dirty[1] = 0;                                \
+                    status = CONFLICT;                                              \
+                    goto done;                                                      \
+                }                                                                   \
+                if (UNLIKELY(force0 | force1)) {                                    \
+                    debugCheckLine(bg, dir, i, 0, force0, name);                    \
+                    debugCheckLine(bg, dir, i, 1, force1, name);                    \
+                    cells[rule] += (size_t)__builtin_popcountll(force0 | force1);    \
+                    bg->why = LineReason(dir, i, wide ? WHY_WIDE : 0).why;          \
+                    BitSetLine(bg, dir, i, 0, force0);                              \
+                    BitSetLine(bg, dir, i, 1, force1);                              \
+                    break; /* the line is queued again */                           \
+                }                                                                   \
+                rule++;                                                             \
+            }
+            LINE_RULES(TRY_LINE_RULE)
+#undef TRY_LINE_RULE
+        } while (0);
+    }
+done:
+    bg->why = WHY_SET;
+    /* Every line goes through the first rule */
+    bg->prop.lines += calls[0];
+    for (size_t r = 0; r < LINE_RULE_COUNT; r++) {
+        bg->prop.ruleCalls[r] += calls[r];
+        bg->prop.ruleCells[r] += cells[r];
+    }
+    return status;
+}
+
+#define LINE_RULE_NAME(kernel, name, wide) name,
+static const char *const lineRuleNames[LINE_RULE_COUNT] = { LINE_RULES(LINE_RULE_NAME) };
+#undef LINE_RULE_NAME
+
+/* One propagator per common size, where every line rule is unrolled for that size,
+   and a generic one reading bg->size for the others */
+#define SIZED_PROPAGATORS(X) X(4) X(6) X(8) X(10) X(12) X(14) X(16)
+
+#define DEFINE_PROPAGATOR(n) \
+    static size_t BitPropagate##n(BitGame *bg) { return BitPropagateSized(bg, n); }
+SIZED_PROPAGATORS(DEFINE_PROPAGATOR)
+#undef DEFINE_PROPAGATOR
+
+static size_t BitPropagateAnySize(BitGame *bg)
+{
+    return BitPropagateSized(bg, bg->size);
+}
+
+/* Picked once, when the bitboard is created */
+static Propagator PropagatorFor(size_t size)
+{
+    switch (size) {
+#define PROPAGATOR_CASE(n) case n: return BitPropagate##n;
+    SIZED_PROPAGATORS(PROPAGATOR_CASE)
+#undef PROPAGATOR_CASE
+    default: return BitPropagateAnySize;
+    }
+}
+
+static inline size_t BitPropagate(BitGame *bg)
+{
+    return bg->propagate(bg);
+}
+
+size_t BitEvidentSolve(BitGame *bg)
+{
+    bg->dirty[0] = bg->dirty[1] = bg->full;
+    return BitPropagate(bg);
+}
+
+/* Returns CONFLICT, leaving game untouched, when the grid contradicts the rules */
+size_t EvidentSolve(Game* game)
+{
+    BitGame bg = BitFromGame(NULL, game);
+    size_t status = BitEvidentSolve(&bg);
+    if (status != CONFLICT)
+        BitToGame(&bg, game);
+    FreeBitGame(&bg);
+    return status;
+}
+
+
+Game CloneGame(const Game *src)
+{
+    Game g = { .size = src->size, .array = malloc(src->size * src->size * sizeof(Cell)), .selected = 0 };
+    if (!g.array) { perror("malloc"); exit(EXIT_FAILURE); }
+    memcpy(g.array, src->array, src->size * src->size * sizeof(Cell));
+    return g;
+}
+
+/* O(1): every line was checked when it got its last cell, see BitLineCompleted */
+size_t BitCheckWin(const BitGame *bg)
+{
+    if (bg->complete[0] != bg->full) return NOT_FINISHED;
+    return bg->broken[0] | bg->broken[1] ? IMPOSSIBLE : WIN;
+}
+
+size_t checkWin(Game* game)
+{
+    /* Loading the bitboard checks every line as it completes; the scan below is only kept to say what is wrong */
+    if (!PrintAndDebug) {
+        for (size_t i = 0; i < game->size * game->size; i++)
+            if (game->array[i].value != '0' && game->array[i].value != '1')
+                return NOT_FINISHED;
+        BitGame bg = BitFromGame(NULL, game);
+        size_t status = BitCheckWin(&bg);
+        FreeBitGame(&bg);
+        return status;
+    }
+
+    // Check if all cells are filled
+    for (size_t i = 0; i < game->size * game->size; i++)
+    {
+        if (game->array[i].value == ' ' || game->array[i].value == 0)
+        {
+            if(PrintAndDebug)
+                printf("Cell %zu is empty\n", i);
+            return NOT_FINISHED;
+        }
+    }
+
+    for (size_t dir = 0; dir < 2; dir++)
+    {
+        for (size_t i = 0; i < game->size; i++)
+        {
+            size_t count0 = 0, count1 = 0;
+
+            for (size_t j = 0; j < game->size; j++)
+            {
+                size_t idx = dir == 0 ? i * game->size + j : j * game->size + i;
+                if (game->array[idx].value == '0') count0++;
+                else if (game->array[idx].value == '1') count1++;
+
+                // Check for three consecutive identical values
+                if (j >= 2)
+                {
+                    size_t idx1 = dir == 0 ? i * game->size + (j-2) : (j-2) * game->size + i;
+                    size_t idx2 = dir == 0 ? i * game->size + (j-1) : (j-1) * game->size + i;
+                    if (game->array[idx1].value == game->array[idx2].value &&
+                        game->array[idx2].value == game->array[idx].value)
+                    {
+                        if(PrintAndDebug)
+                            printf("%s %zu has three consecutive '%c'\n",
+                                dir == 0 ? "Row" : "Column", i, game->array[idx].value);
+                        return IMPOSSIBLE;
+                    }
+                }
+            }
+
+            if (count0 != game->size / 2 || count1 != game->size / 2)
+            {
+                if(PrintAndDebug)
+                    printf("%s %zu does not have equal 0s and 1s\n", dir == 0 ? "Row" : "Column", i);
+                return IMPOSSIBLE;
+            }
+            else if (count0 + count1 != game->size)
+            {
+                if(PrintAndDebug)
+                    printf("%s %zu has empty cells\n", dir == 0 ? "Row" : "Column", i);
+                return NOT_FINISHED;
+            }
+
+            // Check uniqueness against all subsequent rows/columns
+            for (size_t i2 = i + 1; i2 < game->size; i2++)
+            {
+                size_t identical = 1;
+                for (size_t j = 0; j < game->size; j++)
+                {
+                    size_t idx1 = dir == 0 ? i * game->size + j : j * game->size + i;
+                    size_t idx2 = dir == 0 ? i2 * game->size + j : j * game->size + i2;
+                    if (game->array[idx1].value != game->array[idx2].value)
+                    {
+                        identical = 0;
+                        break;
+                    }
+                }
+                if (identical)
+                {
+                    if(PrintAndDebug)
+                        printf("%s %zu and %zu are identical\n", dir == 0 ? "Rows" : "Columns", i, i2);
+                    return IMPOSSIBLE;
+                }
+            }
+        }
+    }
+    return WIN;
+}
+
+/* The largest table that fits in `bytes`, none below one bucket */
+TransTable InitTransTable(size_t bytes)
+{
+    TransTable tt = {0};
+    size_t buckets = 1;
+    while (buckets * 4 * sizeof(TransEntry) <= bytes) buckets <<= 1;
+    if (buckets * 2 * sizeof(TransEntry) > bytes) return tt;
+    tt.entries = calloc(2 * buckets, sizeof(TransEntry));
+    if (!tt.entries) {
+        perror("calloc");
+        exit(EXIT_FAILURE);
+    }
+    tt.mask = buckets - 1;
+    return tt;
+}
+
+void FreeTransTable(TransTable *tt)
+{
+    free(tt->entries);
+    *tt = (TransTable){0};
+}
+
+static inline TransEntry *TransLookup(TransTable *tt, uint64_t key)
+{
+    key |= !key;
+    TransEntry *bucket = &tt->entries[2 * (key & tt->mask)];
+    if (bucket[0].key == key) return &bucket[0];
+    if (bucket[1].key == key) return &bucket[1];
+    return NULL;
+}
+
+static inline void TransStore(TransTable *tt, uint64_t key, size_t work, size_t solutions)
+{
+    if (solutions > UINT32_MAX) return;
+    key |= !key;
+    TransEntry e = { key, work > UINT32_MAX ? UINT32_MAX : (uint32_t)work, (uint32_t)solutions };
+    TransEntry *bucket = &tt->entries[2 * (key & tt->mask)];
+    if (bucket[0].key == key || e.work >= bucket[0].work) {
+        /* The entry it displaces still beats whatever is in the second slot */
+        if (bucket[0].key != key) bucket[1] = bucket[0];
+        bucket[0] = e;
+    }
+    else bucket[1] = e;
+}
+
+
+static int BranchFirstEmpty(BitGame *bg, size_t *idx)
+{
+    for (size_t i = 0; i < bg->size; i++) {
+        Line e = BitEmpty(bg, 0, i);
+        if (e) {
+            *idx = i * bg->size + (size_t)__builtin_ctzll(e);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* Pick the open line with the lowest score, then the cell of that line whose crossing line
+   scores lowest */
+static int BranchOnLines(BitGame *bg, size_t *idx, size_t (*score)(const BitGame*, int, size_t))
+{
+    size_t best = SIZE_MAX, bestLine = 0;
+    int bestDir = 0;
+    for (int dir = 0; dir < 2; dir++) {
+        for (size_t i = 0; i < bg->size; i++) {
+            if (!BitEmpty(bg, dir, i)) continue;
+            size_t sc = score(bg, dir, i);
+            if (sc < best) { best = sc; bestDir = dir; bestLine = i; }
+        }
+    }
+    if (best == SIZE_MAX) return 0;
+
+    size_t bestCell = 0;
+    best = SIZE_MAX;
+    for (Line e = BitEmpty(bg, bestDir, bestLine); e; e &= e - 1) {
+        size_t j = (size_t)__builtin_ctzll(e);
+        size_t sc = score(bg, !bestDir, j);
+        if (sc < best) { best = sc; bestCell = j; }
+    }
+    *idx = bestDir == 0 ? bestLine * bg->size + bestCell : bestCell * bg->size + bestLine;
+    return 1;
+}
+
+static size_t ScoreEmpties(const BitGame *bg, int dir, size_t i)
+{
+    return (size_t)__builtin_popcountll(BitEmpty(bg, dir, i));
+}
+
+/* Values of the scarcer kind still to place, ties broken by empties */
+static size_t ScoreQuota(const BitGame *bg, int dir, size_t i)
+{
+    Line *const *lines = dir == 0 ? bg->rows : bg->cols;
+    size_t half = bg->size / 2;
+    size_t n0 = (size_t)__builtin_popcountll(lines[0][i]);
+    size_t n1 = (size_t)__builtin_popcountll(lines[1][i]);
+    size_t left0 = n0 < half ? half - n0 : 0;
+    size_t left1 = n1 < half ? half - n1 : 0;
+    return (left0 < left1 ? left0 : left1) * (bg->size + 1) + ScoreEmpties(bg, dir, i);
+}
+
+static int BranchFewestEmpties(BitGame *bg, size_t *idx)
+{
+    return BranchOnLines(bg, idx, ScoreEmpties);
+}
+
+static int BranchClosestQuota(BitGame *bg, size_t *idx)
+{
+    return BranchOnLines(bg, idx, ScoreQuota);
+}
+
+/* Try both values on every empty cell and keep the cell whose weaker value forces the most */
+static int BranchMostPropagation(BitGame *bg, size_t *idx)
+{
+    size_t best = 0;
+    int found = 0;
+    for (size_t i = 0; i < bg->size; i++) {
+        for (Line e = BitEmpty(bg, 0, i); e; e &= e - 1) {
+            size_t cell = i * bg->size + (size_t)__builtin_ctzll(e);
+            size_t forced[2];
+            for (int v = 0; v <= 1; v++) {
+                size_t mark = bg->trailLen;
+                BitSetCell(bg, cell, v);
+                uint64_t key = bg->hash;
+                size_t status = BitPropagate(bg);
+                forced[v] = bg->trailLen - mark;
+                BitUndo(bg, mark);
+                if (status == CONFLICT) {
+                    /* The other value is forced: branching here costs a single dead node, and
+                       not even its propagation once the table knows it */
+                    if (bg->tt) TransStore(bg->tt, key, 0, 0);
+                    *idx = cell;
+                    return 1;
+                }
+            }
+            size_t sc = (forced[0] < forced[1] ? forced[0] : forced[1]) * bg->size * bg->size
+                      + forced[0] + forced[1];
+            if (!found || sc > best) {
+                best = sc;
+                *idx = cell;
+                found = 1;
+            }
+        }
+    }
+    return found;
+}
+
+static const BranchStrategy branchStrategies[] = {
+    { "first", BranchFirstEmpty, 0, 0, 0 },
+    { "line",  BranchFewestEmpties, 0, 0, 0 },
+    { "quota", BranchClosestQuota, 0, 0, 0 },
+    { "probe", BranchMostPropagation, 0, 0, 0 },
+};
+#define BRANCH_STRATEGY_COUNT (sizeof(branchStrategies) / sizeof(branchStrategies[0]))
+
+/* Past 16x16 plain branching no longer finishes on empty or sparse grids, whatever the cell
+   order: learning with restarts (see BitSolveRestarts) does, up to 64x64 */
+static const BranchStrategy largeGridStrategy = { "quota", BranchClosestQuota, 0, 2000, 100 };
+
+/* What Solve uses when no strategy is asked for */
+static const BranchStrategy *DefaultStrategy(size_t size)
+{
+    return size > 16 ? &largeGridStrategy : &branchStrategies[0];
+}
+
+/* splitmix64 */
+static inline uint64_t NextRandom(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+/* Failed-literal probing, one step of lookahead before branching: every empty cell is set to 0,
+   then to 1, and propagated. A value that fails fixes the other one, and the cells both values
+   force the same way are fixed as well. Passes repeat until one fixes nothing. A literal that a
+   successful probe forced cannot fail while the grid stays the same, so it is not probed on its
+   own. What gets fixed stays on the trail, for the caller to roll back. */
+static size_t BitProbe(Solver *s)
+{
+    BitGame *bg = &s->bg;
+    size_t size = bg->size;
+    Line implied[2][BIT_MAX_SIZE];  /* literals forced by a successful probe since the last fix */
+    Line forced[2][BIT_MAX_SIZE];   /* what the 0 probe of the current cell forced */
+    TrailEntry agreed[BIT_MAX_SIZE * BIT_MAX_SIZE];
+    int changed = 1;
+    while (changed) {
+        changed = 0;
+        memset(implied, 0, sizeof(implied));
+        for (size_t i = 0; i < size; i++) {
+            for (Line e = BitEmpty(bg, 0, i); e; e &= e - 1) {
+                size_t j = (size_t)__builtin_ctzll(e);
+                Line bit = (Line)1 << j;
+                if (!(BitEmpty(bg, 0, i) & bit)) continue;  /* fixed meanwhile */
+
+                int failed = -1, succeeded = 0;
+                size_t agreedCount = 0;
+                for (int v = 0; v <= 1 && failed < 0; v++) {
+                    if (implied[v][i] & bit) continue;
+                    s->stats.probes++;
+                    size_t mark = bg->trailLen;
+                    BitSetCell(bg, i * size + j, v);
+                    if (BitPropagate(bg) == CONFLICT) failed = v;
+                    else {
+                        if (v == 0) {
+                            memset(forced[0], 0, size * sizeof(Line));
+                            memset(forced[1], 0, size * sizeof(Line));
+                        }
+                        for (size_t t = mark + 1; t < bg->trailLen; t++) {
+                            TrailEntry te = bg->trail[t];
+                            implied[te.v][te.i] |= (Line)1 << te.j;
+                            if (v == 0) forced[te.v][te.i] |= (Line)1 << te.j;
+                            else if (succeeded && (forced[te.v][te.i] >> te.j & 1)) agreed[agreedCount++] = te;
+                        }
+                        succeeded |= v == 0;
+                    }
+                    BitUndo(bg, mark);
+                }
+
+                if (failed >= 0) {
+                    BitSetCell(bg, i * size + j, !failed);
+                    s->stats.probeFixed++;
+                }
+                else {
+                    for (size_t k = 0; k < agreedCount; k++)
+                        BitSetLine(bg, 0, agreed[k].i, agreed[k].v, (Line)1 << agreed[k].j);
+                    s->stats.probeFixed += agreedCount;
+                }
+                if (failed >= 0 || agreedCount) {
+                    if (BitPropagate(bg) == CONFLICT) return CONFLICT;
+                    memset(implied, 0, sizeof(implied));
+                    changed = 1;
+                }
+            }
+        }
+    }
+    return NOT_FINISHED;
+}
+
+/* Conflict-driven learning. Each cell on the trail keeps why it was written (see WHY_SET), so a
+   conflict can be traced back to the few values that caused it: the cells of the failed line,
+   replaced one by one, latest first, by the cells of their own reasons until a single cell of
+   the deepest decision level is left. That cell and the lower-level ones left with it cannot all
+   hold again; the search backjumps to the deepest of those levels, where the nogood forces the
+   cell the other way. Values the root fixed are dropped, so a learner is only good for the
+   search it was made for. */
+
+/* A learner for grids of `size`, in `arena` when one is given, on the heap otherwise. Learned
+   nogoods run from a few cells to about 6 * size; the pool holds 4 * size per nogood on average,
+   and at least one of every length. */
+static Learner InitLearner(Arena *arena, size_t size, size_t capacity)
+{
+    size_t n = size * size;
+    Learner l = { .capacity = capacity, .litCapacity = 4 * size * capacity, .pending = NO_NOGOOD };
+    if (l.litCapacity < n) l.litCapacity = n;
+    /* Widest alignment first */
+    size_t bytes = capacity * sizeof(uint64_t) + (n + 1) * sizeof(size_t) + capacity * sizeof(Nogood)
+                 + (capacity + 7 * n) * sizeof(uint32_t) + l.litCapacity * sizeof(TrailEntry) + n;
+    uint8_t *p = arena ? ArenaAlloc(arena, bytes) : (l.block = malloc(bytes));
+    if (!p) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    l.keys = (uint64_t *)p;               p += capacity * sizeof(uint64_t);
+    l.levelStart = (size_t *)p;           p += (n + 1) * sizeof(size_t);
+    l.nogoods = (Nogood *)p;              p += capacity * sizeof(Nogood);
+    l.remap = (uint32_t *)p;              p += capacity * sizeof(uint32_t);
+    l.watches = (uint32_t *)p;            p += 2 * n * sizeof(uint32_t);
+    l.reason = (uint32_t *)p;             p += n * sizeof(uint32_t);
+    l.pos = (uint32_t *)p;                p += n * sizeof(uint32_t);
+    l.level = (uint32_t *)p;              p += n * sizeof(uint32_t);
+    l.cells = (uint32_t *)p;              p += n * sizeof(uint32_t);
+    l.lower = (uint32_t *)p;              p += n * sizeof(uint32_t);
+    l.lits = (TrailEntry *)p;             p += l.litCapacity * sizeof(TrailEntry);
+    l.seen = p;
+    memset(l.watches, 0xFF, 2 * n * sizeof(uint32_t));
+    memset(l.reason, 0xFF, n * sizeof(uint32_t));
+    return l;
+}
+
+/* Forget every nogood, before a search from another root */
+static void ResetLearner(Learner *l, size_t size)
+{
+    l->count = l->litCount = 0;
+    l->pending = NO_NOGOOD;
+    memset(l->watches, 0xFF, 2 * size * size * sizeof(uint32_t));
+    memset(l->reason, 0xFF, size * size * sizeof(uint32_t));
+}
+
+static void FreeLearner(Learner *l)
+{
+    free(l->block);
+    memset(l, 0, sizeof(*l));
+}
+
+static inline int LitTrue(const BitGame *bg, TrailEntry e)
+{
+    return bg->rows[e.v][e.i] >> e.j & 1;
+}
+
+static inline int LitFalse(const BitGame *bg, TrailEntry e)
+{
+    return bg->rows[!e.v][e.i] >> e.j & 1;
+}
+
+static inline uint32_t *WatchList(const Learner *l, const BitGame *bg, TrailEntry e)
+{
+    return &l->watches[((size_t)e.i * bg->size + e.j) << 1 | e.v];
+}
+
+static inline void WatchNogood(Learner *l, const BitGame *bg, uint32_t id, int k)
+{
+    Nogood *ng = &l->nogoods[id];
+    uint32_t *head = WatchList(l, bg, l->lits[ng->start + k]);
+    ng->next[k] = *head;
+    *head = id << 1 | k;
+}
+
+/* Force the other way the cell of e, the last value of nogood `id` that does not hold yet */
+static inline void NogoodForce(Solver *s, uint32_t id, TrailEntry e)
+{
+    BitGame *bg = &s->bg;
+    s->learn->reason[e.i * bg->size + e.j] = id;
+    bg->why = WHY_NOGOOD;
+    BitSetLine(bg, 0, e.i, !e.v, (Line)1 << e.j);
+    bg->why = WHY_SET;
+    s->stats.nogoodFixed++;
+}
+
+/* Go through the values written since the last call: a nogood watching one of them moves its
+   watch to a value that does not hold yet, or, when there is none, forces its other watch the
+   other way, or fails if that one holds too */
+static size_t NogoodPropagate(Solver *s)
+{
+    BitGame *bg = &s->bg;
+    Learner *l = s->learn;
+    while (bg->watched < bg->trailLen) {
+        uint32_t *link = WatchList(l, bg, bg->trail[bg->watched++]);
+        while (*link != NO_NOGOOD) {
+            uint32_t node = *link;
+            int k = node & 1;
+            Nogood *ng = &l->nogoods[node >> 1];
+            TrailEntry *lits = l->lits + ng->start;
+            TrailEntry other = lits[!k];
+            if (LitFalse(bg, other)) {
+                link = &ng->next[k];
+                continue;
+            }
+            size_t m = 2;
+            while (m < ng->len && LitTrue(bg, lits[m])) m++;
+            if (m < ng->len) {
+                TrailEntry t = lits[k];
+                lits[k] = lits[m];
+                lits[m] = t;
+                *link = ng->next[k];
+                WatchNogood(l, bg, node >> 1, k);
+                continue;
+            }
+            link = &ng->next[k];
+            if (LitTrue(bg, other)) {
+                l->conflict = node >> 1;
+                bg->conflict = (TrailEntry){ .why = WHY_NOGOOD };
+                return CONFLICT;
+            }
+            NogoodForce(s, node >> 1, other);
+        }
+    }
+    return NOT_FINISHED;
+}
+
+/* BitPropagate, with the learned nogoods propagated in turn until neither writes anything */
+static size_t LearnPropagate(Solver *s)
+{
+    BitGame *bg = &s->bg;
+    Learner *l = s->learn;
+    if (l->pending != NO_NOGOOD) {
+        /* Back at its level, the nogood just learned has every value but the first one */
+        const Nogood *ng = &l->nogoods[l->pending];
+        const TrailEntry *lits = l->lits + ng->start;
+        size_t m = 1;
+        while (m < ng->len && LitTrue(bg, lits[m])) m++;
+        if (m == ng->len && !LitTrue(bg, lits[0]) && !LitFalse(bg, lits[0]))
+            NogoodForce(s, l->pending, lits[0]);
+        l->pending = NO_NOGOOD;
+    }
+    for (;;) {
+        if (BitPropagate(bg) == CONFLICT) return CONFLICT;
+        if (NogoodPropagate(s) == CONFLICT) return CONFLICT;
+        if (!(bg->dirty[0] | bg->dirty[1])) return NOT_FINISHED;
+    }
+}
+
+/* The cells whose values forced e, written at trail position p (or, for bg->conflict, whose
+   values failed, with p the trail length), into out. Returns how many there are. For a line
+   rule they are the cells the line had, and, for a rule reading the complete parallel lines,
+   those that still matched it: the others cannot be copies of any completion of the line. */
+static size_t LearnReason(const Learner *l, const BitGame *bg, TrailEntry e, size_t p, uint32_t nogood, uint32_t *out)
+{
+    size_t size = bg->size, count = 0;
+    if (e.why == WHY_NOGOOD) {
+        const Nogood *ng = &l->nogoods[nogood];
+        for (size_t k = 0; k < ng->len; k++) {
+            uint32_t c = (uint32_t)(l->lits[ng->start + k].i * size + l->lits[ng->start + k].j);
+            if (l->pos[c] < p) out[count++] = c;
+        }
+        return count;
+    }
+    if (e.why == WHY_SET) {
+        /* A probe: implied by the branches down to its level */
+        for (size_t d = 1; d <= l->level[e.i * size + e.j]; d++) {
+            TrailEntry b = bg->trail[l->levelStart[d]];
+            out[count++] = (uint32_t)(b.i * size + b.j);
+        }
+        return count;
+    }
+
+    int dir = (e.why & 3) - WHY_ROW;
+    size_t line = dir == 0 ? e.i : e.j;
+    Line *const *lines = dir == 0 ? bg->rows : bg->cols;
+    Line zeros = 0, ones = 0;
+    for (Line set = lines[0][line] | lines[1][line]; set; set &= set - 1) {
+        size_t k = (size_t)__builtin_ctzll(set);
+        uint32_t c = (uint32_t)(dir == 0 ? line * size + k : k * size + line);
+        if (l->pos[c] >= p) continue;
+        out[count++] = c;
+        if (lines[1][line] >> k & 1) ones |= (Line)1 << k;
+        else zeros |= (Line)1 << k;
+    }
+    if (!(e.why & WHY_WIDE)) return count;
+    for (Line done = bg->complete[dir] & ~((Line)1 << line); done; done &= done - 1) {
+        size_t other = (size_t)__builtin_ctzll(done);
+        Line t = lines[1][other];
+        if ((t & zeros) || (t & ones) != ones) continue;
+        size_t first = count;
+        for (size_t k = 0; k < size; k++) {
+            uint32_t c = (uint32_t)(dir == 0 ? other * size + k : k * size + other);
+            if (l->pos[c] >= p) {
+                count = first;  /* completed after e */
+                break;
+            }
+            out[count++] = c;
+        }
+    }
+    return count;
+}
+
+static int CompareKeys(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/* The database is full: keep the nogoods that are the reason of a cell on the trail, and the
+   better half of the others, ranked by activity, then length, then age */
+static void ReduceNogoods(Learner *l, const BitGame *bg)
+{
+    size_t size = bg->size, n = size * size, ranked = 0;
+    for (uint32_t id = 0; id < l->count; id++) {
+        const Nogood *ng = &l->nogoods[id];
+        int locked = 0;
+        for (size_t k = 0; k < ng->len && k < 2; k++) {
+            TrailEntry e = l->lits[ng->start + k];
+            locked |= l->reason[e.i * size + e.j] == id && LitFalse(bg, e);
+        }
+        l->remap[id] = locked;
+        if (!locked) l->keys[ranked++] = (uint64_t)ng->activity << 40 | (uint64_t)(0xFFFF - ng->len) << 24 | id;
+    }
+    qsort(l->keys, ranked, sizeof(uint64_t), CompareKeys);
+    uint64_t threshold = ranked ? l->keys[ranked / 2] : 0;
+
+    size_t kept = 0, litCount = 0;
+    for (uint32_t id = 0; id < l->count; id++) {
+        Nogood ng = l->nogoods[id];
+        uint64_t key = (uint64_t)ng.activity << 40 | (uint64_t)(0xFFFF - ng.len) << 24 | id;
+        if (!l->remap[id] && key < threshold) {
+            l->remap[id] = NO_NOGOOD;
+            continue;
+        }
+        memmove(l->lits + litCount, l->lits + ng.start, ng.len * sizeof(TrailEntry));
+        ng.start = (uint32_t)litCount;
+        ng.activity /= 2;
+        litCount += ng.len;
+        l->nogoods[kept] = ng;
+        l->remap[id] = (uint32_t)kept++;
+    }
+    for (size_t c = 0; c < n; c++)
+        if (l->reason[c] < l->count) l->reason[c] = l->remap[l->reason[c]];
+    l->count = kept;
+    l->litCount = litCount;
+    memset(l->watches, 0xFF, 2 * n * sizeof(uint32_t));
+    for (uint32_t id = 0; id < kept; id++) {
+        if (l->nogoods[id].len < 2) continue;
+        WatchNogood(l, bg, id, 0);
+        WatchNogood(l, bg, id, 1);
+    }
+}
+
+/* Analyse the conflict in bg->conflict, at depth s->depth: learn its nogood and set s->jumpTo
+   to the level where it forces a cell. Nothing is learned when the root itself failed, or when
+   the nogood does not fit even after a cleanup, and the search then backtracks as usual. */
+static void BitLearn(Solver *s)
+{
+    BitGame *bg = &s->bg;
+    Learner *l = s->learn;
+    size_t size = bg->size, n = size * size;
+    memset(l->pos, 0xFF, n * sizeof(uint32_t));
+    memset(l->seen, 0, n);
+    size_t d = 0;
+    for (size_t t = 0; t < bg->trailLen; t++) {
+        while (d < s->depth && l->levelStart[d + 1] <= t) d++;
+        size_t c = bg->trail[t].i * size + bg->trail[t].j;
+        l->pos[c] = (uint32_t)t;
+        l->level[c] = (uint32_t)d;
+    }
+
+    if (bg->conflict.why == WHY_NOGOOD) l->nogoods[l->conflict].activity++;
+    size_t count = LearnReason(l, bg, bg->conflict, bg->trailLen, l->conflict, l->cells);
+    uint32_t top = 0;
+    for (size_t k = 0; k < count; k++)
+        if (l->level[l->cells[k]] > top) top = l->level[l->cells[k]];
+    if (!top) return;
+
+    /* open: cells of the top level still to replace by their reasons */
+    size_t open = 0, lower = 0, t = bg->trailLen;
+    TrailEntry uip;
+    for (;;) {
+        for (size_t k = 0; k < count; k++) {
+            uint32_t c = l->cells[k];
+            if (l->seen[c] || !l->level[c]) continue;
+            l->seen[c] = 1;
+            if (l->level[c] == top) open++;
+            else l->lower[lower++] = c;
+        }
+        size_t c;
+        do {
+            uip = bg->trail[--t];
+            c = uip.i * size + uip.j;
+        } while (!l->seen[c] || l->level[c] != top);
+        if (--open == 0) break;
+        if (uip.why == WHY_NOGOOD) l->nogoods[l->reason[c]].activity++;
+        count = LearnReason(l, bg, uip, t, l->reason[c], l->cells);
+    }
+
+    size_t len = lower + 1;
+    if (l->count == l->capacity || l->litCount + len > l->litCapacity) ReduceNogoods(l, bg);
+    if (l->count == l->capacity || l->litCount + len > l->litCapacity) return;
+    uint32_t id = (uint32_t)l->count++;
+    Nogood *ng = &l->nogoods[id];
+    *ng = (Nogood){ .start = (uint32_t)l->litCount, .len = (uint32_t)len, .next = { NO_NOGOOD, NO_NOGOOD } };
+    TrailEntry *lits = l->lits + ng->start;
+    l->litCount += ng->len;
+    lits[0] = (TrailEntry){ uip.i, uip.j, uip.v, 0 };
+    /* lits[1]: the deepest of the others, the last one to go on a backjump */
+    uint32_t jump = 0;
+    for (size_t k = 0; k < lower; k++) {
+        uint32_t c = l->lower[k];
+        size_t i = c / size, j = c % size;
+        lits[k + 1] = (TrailEntry){ (uint8_t)i, (uint8_t)j, (uint8_t)(bg->rows[1][i] >> j & 1), 0 };
+        if (l->level[c] > jump) {
+            jump = l->level[c];
+            TrailEntry deepest = lits[k + 1];
+            lits[k + 1] = lits[1];
+            lits[1] = deepest;
+        }
+    }
+    if (ng->len >= 2) {
+        WatchNogood(l, bg, id, 0);
+        WatchNogood(l, bg, id, 1);
+    }
+    l->pending = id;
+    s->jumpTo = jump + 1;
+    s->stats.learned++;
+}
+
+/* Cancelled by another thread or out of node budget: the search unwinds without a verdict */
+static inline int SolverStopped(const Solver *s)
+{
+    return (s->cancel && atomic_load_explicit(s->cancel, memory_order_relaxed))
+        || (s->budget && s->stats.nodes > s->budget);
+}
+
+/* The grid is back to the state BitSolve was called with and its subtree was searched to the
+   end: tell the table how many solutions it had, unless the search was cut short */
+static inline void SolverRecord(Solver *s, size_t nodes, size_t solutions)
+{
+    if (!s->bg.tt || SolverStopped(s)) return;
+    TransStore(s->bg.tt, s->bg.hash, s->stats.nodes - nodes, s->solutions - solutions);
+}
+
+/* Backtracking in place. Every solution found is counted and handed to onSolution; once
+   `limit` of them are found the search stops and returns WIN, the grid holding the last one.
+   Otherwise the subtree is exhausted (IMPOSSIBLE) and the grid is rolled back to the state it
+   was called with. */
+static size_t BitSolve(Solver *s)
+{
+    if (UNLIKELY(SolverStopped(s)))
+        return IMPOSSIBLE;
+
+    BitGame *bg = &s->bg;
+    if (bg->tt) {
+        const TransEntry *known = TransLookup(bg->tt, bg->hash);
+        if (known && (!known->solutions || s->countOnly)) {
+            s->stats.ttHits++;
+            s->solutions += known->solutions;
+            if (s->limit && s->solutions >= s->limit) {
+                s->solutions = s->limit;
+                return WIN;
+            }
+            return IMPOSSIBLE;
+        }
+        s->stats.ttMisses++;
+    }
+    size_t nodes = s->stats.nodes, solutions = s->solutions;
+
+    size_t mark = bg->trailLen;
+again:;
+    uint64_t t0 = NowNs();
+    size_t status = s->learn ? LearnPropagate(s) : BitPropagate(bg);
+    uint64_t t1 = NowNs();
+    s->stats.propagateNs += t1 - t0;
+    if (status != CONFLICT && s->strategy->lookahead) {
+        status = BitProbe(s);
+        uint64_t t2 = NowNs();
+        s->stats.probeNs += t2 - t1;
+        t1 = t2;
+    }
+    if (status == CONFLICT) {
+        if (s->learn) BitLearn(s);
+        BitUndo(bg, mark);
+        SolverRecord(s, nodes, solutions);
+        return IMPOSSIBLE;
+    }
+
+    size_t idx;
+    int open = s->strategy->pick(bg, &idx);
+    s->stats.branchNs += NowNs() - t1;
+    if (!open) {
+        if (BitCheckWin(bg) == WIN) {
+            s->solutions++;
+            if (s->onSolution) s->onSolution(bg, s->solutionCtx);
+            if (s->limit && s->solutions >= s->limit) return WIN;
+        }
+        BitUndo(bg, mark);
+        SolverRecord(s, nodes, solutions);
+        return IMPOSSIBLE;
+    }
+
+    // Try '0' and '1' on the chosen cell and recurse
+    int first = s->rng ? (int)(NextRandom(&s->rng) & 1) : 0;
+    if (++s->depth > s->stats.maxDepth) s->stats.maxDepth = s->depth;
+    for (int k = 0; k <= 1; k++) {
+        int val = first ^ k;
+        size_t branch = bg->trailLen;
+        s->stats.nodes++;
+        if (s->learn) s->learn->levelStart[s->depth] = branch;
+        BitSetCell(bg, idx, val);
+        if (BitSolve(s) == WIN) {
+            s->depth--;
+            return WIN;
+        }
+        BitUndo(bg, branch);
+        if (UNLIKELY(SolverStopped(s))) {
+            s->depth--;
+            BitUndo(bg, mark);
+            return IMPOSSIBLE;
+        }
+        s->stats.backtracks++;
+        if (s->jumpTo) {
+            /* The subtree was not searched to the end: nothing to record */
+            s->depth--;
+            if (s->jumpTo == s->depth + 1) {
+                s->jumpTo = 0;
+                goto again;
+            }
+            s->stats.jumped++;
+            BitUndo(bg, mark);
+            return IMPOSSIBLE;
+        }
+    }
+    s->depth--;
+    BitUndo(bg, mark);
+    SolverRecord(s, nodes, solutions);
+    return IMPOSSIBLE;
+}
+
+/* Folds the counters of one search into another's. Depths are not additive: maxDepth keeps
+   the deeper of the two. */
+static void AddStats(SolverStats *into, const SolverStats *from)
+{
+    into->nodes += from->nodes;
+    into->backtracks += from->backtracks;
+    if (from->maxDepth > into->maxDepth) into->maxDepth = from->maxDepth;
+    into->propagateNs += from->propagateNs;
+    into->branchNs += from->branchNs;
+    into->ttHits += from->ttHits;
+    into->ttMisses += from->ttMisses;
+    into->probes += from->probes;
+    into->probeFixed += from->probeFixed;
+    into->probeNs += from->probeNs;
+    into->learned += from->learned;
+    into->jumped += from->jumped;
+    into->nogoodFixed += from->nogoodFixed;
+    into->restarts += from->restarts;
+    into->prop.passes += from->prop.passes;
+    into->prop.lines += from->prop.lines;
+    for (size_t r = 0; r < LINE_RULE_COUNT; r++) {
+        into->prop.ruleCalls[r] += from->prop.ruleCalls[r];
+        into->prop.ruleCells[r] += from->prop.ruleCells[r];
+    }
+}
+
+/* The Luby sequence 1 1 2 1 1 2 4 1 1 2 1 1 2 4 8 ..., for k >= 1 */
+static size_t Luby(size_t k)
+{
+    for (;;) {
+        size_t p = 2;
+        while (p - 1 < k) p <<= 1;
+        if (p - 1 == k) return p >> 1;
+        k -= (p >> 1) - 1;  /* the same sequence restarts after each 2^m - 1 terms */
+    }
+}
+
+/* BitSolve from the root of s, the grid with every line dirty. With s->strategy->restart the
+   search on large grids is heavy-tailed: a few early values can trap it in a subtree without
+   solution that it cannot leave in any reasonable time. Each run then gets a budget of
+   restart * Luby(run) nodes, and the next one starts over from the root with a new random value
+   order drawn from *rng, keeping the learned nogoods. The budgets grow without bound, so a grid
+   without solution is still proved so, by the first run that exhausts its tree. */
+static size_t BitSolveRestarts(Solver *s, uint64_t *rng)
+{
+    size_t status;
+    for (size_t run = 1;; run++) {
+        if (s->strategy->restart) s->budget = s->stats.nodes + s->strategy->restart * Luby(run);
+        s->bg.dirty[0] = s->bg.dirty[1] = s->bg.full;
+        status = BitSolve(s);
+        if (status == WIN || !s->budget || s->stats.nodes <= s->budget) break;
+        s->stats.restarts++;
+        s->depth = s->jumpTo = 0;
+        s->rng = NextRandom(rng) | 1;
+    }
+    s->budget = 0;
+    return status;
+}
+
+/* Returns WIN with the solution written into game, IMPOSSIBLE with game untouched.
+   The search state is taken from `arena` when one is given, instead of the heap, and the
+   states it settles are shared through `tt` when one is given. */
+size_t Solve(Arena *arena, TransTable *tt, Game* game, const BranchStrategy *strategy, SolverStats *stats)
+{
+    Solver s = { .bg = BitFromGame(arena, game), .strategy = strategy, .limit = 1 };
+    Learner learn = { 0 };
+    if (tt && tt->entries) s.bg.tt = tt;
+    if (strategy->learn) {
+        learn = InitLearner(arena, game->size, strategy->learn);
+        s.learn = &learn;
+    }
+    uint64_t rng = 1;
+    size_t status = BitSolveRestarts(&s, &rng);
+    if (status == WIN)
+        BitToGame(&s.bg, game);
+    s.stats.prop = s.bg.prop;
+    FreeBitGame(&s.bg);
+    FreeLearner(&learn);
+    if (stats) *stats = s.stats;
+    return status;
+}
+
+/* Number of solutions of game, counting stops at `limit` (0: no limit). A limit of 2 is a
+   uniqueness check. onSolution, if given, is called with each solution as it is found. */
+size_t CountSolutions(Arena *arena, TransTable *tt, const Game* game, const BranchStrategy *strategy, size_t limit,
+                      SolutionFn onSolution, void *ctx, SolverStats *stats)
+{
+    Solver s = { .bg = BitFromGame(arena, game), .strategy = strategy, .limit = limit,
+                 .onSolution = onSolution, .solutionCtx = ctx, .countOnly = !onSolution };
+    if (tt && tt->entries) s.bg.tt = tt;
+    s.bg.dirty[0] = s.bg.dirty[1] = s.bg.full;
+    BitSolve(&s);
+    s.stats.prop = s.bg.prop;
+    FreeBitGame(&s.bg);
+    if (stats) *stats = s.stats;
+    return s.solutions;
+}
+
+/* Parallel search: the first `depth` levels of the tree are expanded on one thread, every open
+   node at that depth becomes a task replayed from its decisions by a pool worker. Solutions are
+   counted across workers, and reaching the limit cancels all of them. */
+typedef struct {
+    Decision *items;   /* `depth` decisions per subproblem */
+    size_t count;
+    size_t capacity;
+} Subproblems;
+
+typedef struct {
+    Solver *solvers;   /* one per worker, each with its own copy of the root grid */
+    Subproblems subproblems;
+    size_t depth;
+    size_t limit;
+    atomic_size_t solutions;
+    atomic_int stop;
+    Mutex lock;        /* serializes onSolution */
+    SolutionFn onSolution;
+    void *solutionCtx;
+} ParallelSearch;
+
+static void ParallelOnSolution(const BitGame *bg, void *ctx)
+{
+    ParallelSearch *ps = ctx;
+    size_t n = atomic_fetch_add(&ps->solutions, 1) + 1;
+    if (ps->limit && n > ps->limit) return;
+    if (ps->onSolution) {
+        MutexLock(&ps->lock);
+        ps->onSolution(bg, ps->solutionCtx);
+        MutexUnlock(&ps->lock);
+    }
+    if (ps->limit && n == ps->limit) atomic_store(&ps->stop, 1);
+}
+
+static void SplitSearch(Solver *s, ParallelSearch *ps, Decision *path, size_t depth)
+{
+    BitGame *bg = &s->bg;
+    size_t idx;
+    if (atomic_load(&ps->stop)) return;
+    if (!s->strategy->pick(bg, &idx)) {
+        if (BitCheckWin(bg) == WIN) ParallelOnSolution(bg, ps);
+        return;
+    }
+    if (depth == ps->depth) {
+        for (size_t d = 0; d < depth; d++) da_append(&ps->subproblems, path[d]);
+        return;
+    }
+
+    for (int val = 0; val <= 1; val++) {
+        size_t branch = bg->trailLen;
+        s->stats.nodes++;
+        BitSetCell(bg, idx, val);
+        path[depth] = (Decision){ (uint16_t)idx, (uint8_t)val };
+        if (BitPropagate(bg) != CONFLICT) SplitSearch(s, ps, path, depth + 1);
+        BitUndo(bg, branch);
+    }
+}
+
+static void ParallelSearchTask(void *ctx, size_t worker, size_t task)
+{
+    ParallelSearch *ps = ctx;
+    if (atomic_load_explicit(&ps->stop, memory_order_relaxed)) return;
+
+    Solver *s = &ps->solvers[worker];
+    size_t mark = s->bg.trailLen;
+    const Decision *path = &ps->subproblems.items[task * ps->depth];
+    size_t status = NOT_FINISHED;
+    for (size_t d = 0; d < ps->depth && status != CONFLICT; d++) {
+        BitSetCell(&s->bg, path[d].cell, path[d].v);
+        status = BitPropagate(&s->bg);
+    }
+    if (status != CONFLICT) BitSolve(s);
+    BitUndo(&s->bg, mark);
+}
+
+/* CountSolutions with the tree searched by `workers` threads */
+size_t CountSolutionsParallel(const Game* game, const BranchStrategy *strategy, size_t workers, size_t limit,
+                              SolutionFn onSolution, void *ctx, SolverStats *stats)
+{
+    Solver root = { .bg = BitFromGame(NULL, game), .strategy = strategy };
+    ParallelSearch ps = { .limit = limit, .lock = MUTEX_INIT, .onSolution = onSolution, .solutionCtx = ctx };
+    root.bg.dirty[0] = root.bg.dirty[1] = root.bg.full;
+
+    /* About eight subproblems per worker leaves room for stealing */
+    while (ps.depth < 16 && ((size_t)1 << ps.depth) < 8 * workers) ps.depth++;
+    Decision path[16];
+    if (BitPropagate(&root.bg) != CONFLICT)
+        SplitSearch(&root, &ps, path, 0);
+    root.stats.prop = root.bg.prop;
+
+    size_t tasks = ps.subproblems.count / ps.depth;
+    if (tasks && !atomic_load(&ps.stop)) {
+        if (workers > tasks) workers = tasks;
+        ps.solvers = calloc(workers, sizeof(Solver));
+        if (!ps.solvers) {
+            perror("calloc");
+            exit(EXIT_FAILURE);
+        }
+        for (size_t w = 0; w < workers; w++)
+            ps.solvers[w] = (Solver){ .bg = CloneBitGame(&root.bg), .strategy = strategy, .cancel = &ps.stop,
+                                      .onSolution = ParallelOnSolution, .solutionCtx = &ps };
+
+        RunTasks(workers, tasks, ParallelSearchTask, &ps);
+
+        for (size_t w = 0; w < workers; w++) {
+            /* Worker depths start below the split */
+            SolverStats *ws = &ps.solvers[w].stats;
+            ws->prop = ps.solvers[w].bg.prop;
+            if (ws->maxDepth) ws->maxDepth += ps.depth;
+            AddStats(&root.stats, ws);
+            FreeBitGame(&ps.solvers[w].bg);
+        }
+        free(ps.solvers);
+    }
+
+    da_free(&ps.subproblems);
+    FreeBitGame(&root.bg);
+    if (stats) *stats = root.stats;
+    size_t found = atomic_load(&ps.solutions);
+    return limit && found > limit ? limit : found;
+}
+
+static void StoreSolution(const BitGame *bg, void *ctx)
+{
+    BitToGame(bg, ctx);
+}
+
+/* Same contract as Solve, the tree being searched by `workers` threads */
+size_t SolveParallel(Game* game, const BranchStrategy *strategy, size_t workers, SolverStats *stats)
+{
+    return CountSolutionsParallel(game, strategy, workers, 1, StoreSolution, game, stats) ? WIN : IMPOSSIBLE;
+}
+
+/* Portfolio: no search configuration is best on every grid, so several of them race on the same
+   grid, one thread each, and the first to settle it cancels the others. The configurations vary
+   the branching, the value order, probing and learning. */
+typedef struct {
+    const char *name;
+    BranchStrategy strategy;
+    uint64_t seed;  /* non-zero: random value order */
+} RaceEntry;
+
+/* Ordered so that each entry saves the most on top of the ones before it, measured one
+   configuration at a time on minimal 14x14 and 16x16 puzzles. Past 16x16 only the restarting
+   entry reliably finishes, see DefaultStrategy. */
+static const RaceEntry raceEntries[] = {
+    { "quota+lookahead",     { "quota", BranchClosestQuota,    1, 0,    0 },   0 },
+    { "probe+learn",         { "probe", BranchMostPropagation, 0, 2000, 0 },   0 },
+    { "quota+learn+restart", { "quota", BranchClosestQuota,    0, 2000, 100 }, 0 },
+    { "first+learn",         { "first", BranchFirstEmpty,      0, 2000, 0 },   0 },
+    { "line+learn",          { "line",  BranchFewestEmpties,   0, 2000, 0 },   0 },
+    { "first",               { "first", BranchFirstEmpty,      0, 0,    0 },   0 },
+    { "first+lookahead",     { "first", BranchFirstEmpty,      1, 0,    0 },   0 },
+    { "line+all+random",     { "line",  BranchFewestEmpties,   1, 2000, 0 },   0x9E3779B97F4A7C15ull },
+};
+#define RACE_ENTRY_COUNT (sizeof(raceEntries) / sizeof(raceEntries[0]))
+
+typedef struct {
+    const Game *game;
+    atomic_int stop;
+    atomic_size_t winner;  /* task + 1 of the first to finish, 0 while racing */
+    size_t status;
+    BitGame solution;      /* the winner's grid */
+    SolverStats stats;     /* the winner's counters */
+} Race;
+
+static void RaceTask(void *ctx, size_t worker, size_t task)
+{
+    (void)worker;
+    Race *race = ctx;
+    const RaceEntry *entry = &raceEntries[task];
+    Solver s = { .bg = BitFromGame(NULL, race->game), .strategy = &entry->strategy, .limit = 1,
+                 .cancel = &race->stop, .rng = entry->seed };
+    Learner learn = { 0 };
+    if (entry->strategy.learn) {
+        learn = InitLearner(NULL, race->game->size, entry->strategy.learn);
+        s.learn = &learn;
+    }
+    uint64_t rng = task + 1;
+    size_t status = BitSolveRestarts(&s, &rng);
+    FreeLearner(&learn);
+
+    /* A search cancelled by the winner can only come second */
+    size_t none = 0;
+    if (atomic_compare_exchange_strong(&race->winner, &none, task + 1)) {
+        atomic_store(&race->stop, 1);
+        race->status = status;
+        s.stats.prop = s.bg.prop;
+        race->stats = s.stats;
+        race->solution = s.bg;
+        return;
+    }
+    FreeBitGame(&s.bg);
+}
+
+/* Same contract as Solve, with the first `workers` configurations (at most RACE_ENTRY_COUNT)
+   racing on the grid. The name of the one that won goes to *winner. */
+size_t SolveRace(Game *game, size_t workers, SolverStats *stats, const char **winner)
+{
+    Race race = { .game = game };
+    if (workers > RACE_ENTRY_COUNT) workers = RACE_ENTRY_COUNT;
+    RunTasks(workers, workers, RaceTask, &race);
+    size_t task = atomic_load(&race.winner) - 1;
+    if (race.status == WIN) BitToGame(&race.solution, game);
+    FreeBitGame(&race.solution);
+    if (stats) *stats = race.stats;
+    if (winner) *winner = raceEntries[task].name;
+    return race.status;
+}
+
+/* Puzzle generation: a random solution is found by searching an empty grid with a random value
+   order (with learning and restarts past 16x16, see DefaultStrategy), then clues are dropped in
+   random order as long as the solution stays unique. The grid with a clue c removed is unique
+   iff the current clues with c flipped have no solution, so each removal costs a single
+   satisfiability check on the solver, which is reused for all of them. */
+typedef struct {
+    Line solution[BIT_MAX_SIZE];  /* ones mask of each row */
+    Line clues[BIT_MAX_SIZE];     /* cells given in each row */
+    size_t clueCount;
+} Puzzle;
+
+/* Reset s to an empty grid and write the given cells of the solution, with `flip` inverted
+   (flip >= size*size for none) */
+static void SetClues(Solver *s, const Puzzle *p, size_t flip)
+{
+    BitGame *bg = &s->bg;
+    BitUndo(bg, 0);
+    for (size_t i = 0; i < bg->size; i++) {
+        Line clues = p->clues[i];
+        Line flipped = flip / bg->size == i ? (Line)1 << (flip % bg->size) & clues : 0;
+        clues &= ~flipped;
+        BitSetLine(bg, 0, i, 0, clues & ~p->solution[i]);
+        BitSetLine(bg, 0, i, 1, clues & p->solution[i]);
+        if (flipped) BitSetLine(bg, 0, i, !(p->solution[i] & flipped), flipped);
+    }
+}
+
+/* Past 16x16 proving that a flipped clue has no solution can take longer than the rest of the
+   generation put together; each check is then cut at this many nodes */
+#define GENERATE_CHECK_BUDGET 50
+
+/* s must hold an empty grid of the wanted size and, past 16x16, a learner for it; it is left in
+   an unspecified state */
+void GeneratePuzzle(Solver *s, uint64_t seed, Puzzle *p)
+{
+    BitGame *bg = &s->bg;
+    size_t n = bg->size;
+    uint64_t rng = seed;
+    const BranchStrategy *checks = s->strategy;
+
+    memset(p, 0, sizeof(*p));
+    BitUndo(bg, 0);
+    s->limit = 1;
+    s->solutions = 0;
+    s->onSolution = NULL;
+    s->rng = NextRandom(&rng) | 1;
+    if (s->learn) {
+        s->strategy = DefaultStrategy(n);
+        ResetLearner(s->learn, n);
+    }
+    BitSolveRestarts(s, &rng);
+    s->strategy = checks;
+    for (size_t i = 0; i < n; i++) {
+        p->solution[i] = bg->rows[1][i];
+        p->clues[i] = bg->full;
+    }
+    p->clueCount = n * n;
+    s->rng = 0;
+
+    uint16_t order[BIT_MAX_SIZE * BIT_MAX_SIZE];
+    for (size_t c = 0; c < n * n; c++) order[c] = (uint16_t)c;
+    for (size_t c = n * n - 1; c > 0; c--) {
+        size_t r = NextRandom(&rng) % (c + 1);
+        uint16_t t = order[c]; order[c] = order[r]; order[r] = t;
+    }
+
+    for (size_t k = 0; k < n * n; k++) {
+        size_t c = order[k];
+        SetClues(s, p, c);
+        s->solutions = 0;
+        if (s->learn) {
+            ResetLearner(s->learn, n);
+            s->budget = s->stats.nodes + GENERATE_CHECK_BUDGET;
+        }
+        /* A check out of budget settled nothing: the clue stays, which is always safe */
+        if (BitSolve(s) != WIN && !(s->budget && s->stats.nodes > s->budget)) {
+            p->clues[c / n] &= ~((Line)1 << (c % n));
+            p->clueCount--;
+        }
+        s->budget = 0;
+    }
+}
+
+void ExportLevel(Game *game)
+{
+    /* Temporarily disable raw mode to read filename */
+    disableRawMode();
+    printf("\nNom du niveau (sans extension): ");
+    fflush(stdout);
+
+    char name[128] = {0};
+    if (fgets(name, sizeof(name), stdin) == NULL || name[0] == '\n') {
+        printf("Export annulé.\n");
+        enableRawMode();
+        return;
+    }
+    /* Strip trailing newline */
+    name[strcspn(name, "\n")] = '\0';
+
+    char path[256];
+    snprintf(path, sizeof(path), "levels/%s.binero", name);
+
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        printf("Erreur: %s\n", strerror(errno));
+        enableRawMode();
+        return;
+    }
+    WriteLevel(f, game);
+    fclose(f);
+    printf("Exporté vers %s\n", path);
+    enableRawMode();
+    g_force_redraw = 1;
+}
+
+typedef struct {
+    char **items;
+    size_t count;
+    size_t capacity;
+} Paths;
+
+static void FreePaths(Paths *paths)
+{
+    nob_da_foreach(char*, it, paths) free(*it);
+    da_free(paths);
+    memset(paths, 0, sizeof(*paths));
+}
+
+static int IsLevelName(const char *name)
+{
+    size_t len = strlen(name);
+    return len > 7 && strcmp(name + len - 7, ".binero") == 0;
+}
+
+static int ComparePaths(const void *a, const void *b)
+{
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+static int IsDirectory(const char *path)
+{
+#ifdef _WIN32
+    DWORD attr = GetFileAttributesA(path);
+    return attr != INVALID_FILE_ATTRIBUTES && (attr & FILE_ATTRIBUTE_DIRECTORY);
+#else
+    struct stat st;
+    return stat(path, &st) == 0 && S_ISDIR(st.st_mode);
+#endif
+}
+
+/* Append the .binero files of dir (solutions are .binero.sol, so they never match), sorted */
+static void ListLevels(const char *dirPath, Paths *out)
+{
+    size_t first = out->count;
+    char path[4096];
+#ifdef _WIN32
+    char pattern[4096];
+    snprintf(pattern, sizeof(pattern), "%s\\*.binero", dirPath);
     WIN32_FIND_DATAA ffd;
     HANDLE hFind = FindFirstFileA(pattern, &ffd);
     if (hFind != INVALID_HANDLE_VALUE) {
         do {
-            size_t len = strlen(ffd.cFileName);
-            if (len > 7 && strcmp(ffd.cFileName + len - 7, ".binero") == 0
-                && !(len > 11 && strcmp(ffd.cFileName + len - 11, ".binero.sol") == 0)) {
-                snprintf(paths[count], sizeof(paths[count]), "%s/%s", levelsDir, ffd.cFileName);
-                count++;
+            if (IsLevelName(ffd.cFileName)) {
+                snprintf(path, sizeof(path), "%s/%s", dirPath, ffd.cFileName);
+                da_append(out, strdup(path));
+            }
+        } while (FindNextFileA(hFind, &ffd));
+        FindClose(hFind);
+    }
+#else
+    DIR *dir = opendir(dirPath);
+    if (dir) {
+        struct dirent *ent;
+        while ((ent = readdir(dir)) != NULL) {
+            if (IsLevelName(ent->d_name)) {
+                snprintf(path, sizeof(path), "%s/%s", dirPath, ent->d_name);
+                da_append(out, strdup(path));
+            }
+        }
+        closedir(dir);
+    }
+#endif
+    qsort(out->items + first, out->count - first, sizeof(*out->items), ComparePaths);
+}
+
+Game SelectLevel(void)
+{
+    /* Scan levels/ directory for .binero files */
+    Paths paths = {0};
+    ListLevels("levels", &paths);
+    size_t count = paths.count;
+
+    /* Interactive arrow-key menu */
+    enableRawMode();
+    int sel = 0, prev_sel = -1;
+    int total_items = (int)count + 1; /* levels + empty grid */
+    size_t emptySize = 14;           /* left/right on the empty grid */
+
+    /* Draw once */
+    printf("\x1b[H\x1b[2J\x1b[?25l"); /* clear + hide cursor */
+    printf("=== BINERO ===\r\n\r\n");
+    for (size_t i = 0; i < count; i++)
+        printf("  %zu) %s\r\n", i + 1, paths.items[i]);
+    printf("  0) Grille vide %zux%zu\r\n", emptySize, emptySize);
+    printf("\r\nFleches: haut/bas | gauche/droite: taille de la grille vide | Entree: valider\r\n");
+
+    for (;;) {
+        /* Update only changed lines */
+        if (prev_sel != sel) {
+            if (prev_sel >= 0) {
+                /* Unhighlight previous (menu items start at row 3) */
+                printf("\x1b[%d;1H\x1b[2K", prev_sel + 3);
+                if (prev_sel < (int)count)
+                    printf("  %d) %s", prev_sel + 1, paths.items[prev_sel]);
+                else
+                    printf("  0) Grille vide %zux%zu", emptySize, emptySize);
+            }
+            /* Highlight current */
+            printf("\x1b[%d;1H\x1b[2K", sel + 3);
+            if (sel < (int)count)
+                printf("  " BG_WHITE "%d) %s" RESET, sel + 1, paths.items[sel]);
+            else
+                printf("  " BG_WHITE "0) Grille vide %zux%zu" RESET, emptySize, emptySize);
+
+            prev_sel = sel;
+        }
+        fflush(stdout);
+
+        char c;
+        int resize = 0;
+#ifdef _WIN32
+        c = (char)_getch();
+        if (c == 0 || c == (char)0xe0) {
+            char c2 = (char)_getch();
+            if      (c2 == 72 && sel > 0)              sel--;  /* up */
+            else if (c2 == 80 && sel < total_items - 1) sel++; /* down */
+            else if (c2 == 75 || c2 == 77) resize = c2 == 77 ? 2 : -2;
+        }
+        else if (c == '\r') break;
+        else if (c == 'q') { sel = -1; break; } /* quick exit */
+#else
+        {
+            ssize_t n = read(STDIN_FILENO, &c, 1);
+            if (n <= 0) break;
+        }
+        if (c == '\x1b') {
+            char seq[2];
+            if (read(STDIN_FILENO, &seq[0], 1) > 0 &&
+                read(STDIN_FILENO, &seq[1], 1) > 0 && seq[0] == '[') {
+                if      (seq[1] == 'A' && sel > 0)              sel--;  /* up */
+                else if (seq[1] == 'B' && sel < total_items - 1) sel++; /* down */
+                else if (seq[1] == 'C' || seq[1] == 'D') resize = seq[1] == 'C' ? 2 : -2;
+            }
+        }
+        else if (c == '\r' || c == '\n') break;
+        else if (c == 'q') { sel = -1; break; } /* quick exit */
+#endif
+        if (resize && sel == (int)count) {
+            size_t next = emptySize + (size_t)resize;
+            if (next >= 4 && next <= BIT_MAX_SIZE) {
+                emptySize = next;
+                prev_sel = -1; /* redraw the entry */
+            }
+        }
+    }
+
+    printf("\x1b[?25h"); /* restore cursor */
+    fflush(stdout);
+    disableRawMode();
+
+    Game game = {0};
+    if (sel >= 0 && sel < (int)count) {
+        game = LoadLevel(paths.items[sel]);
+        char solPath[4100];
+        snprintf(solPath, sizeof(solPath), "%s.sol", paths.items[sel]);
+        if (game.size) LoadSolution(solPath, game.size);
+    }
+    else if (sel == (int)count) {
+        game = InitGame(emptySize);
+    }
+    FreePaths(&paths);
+    return game;
+}
+
+static const BranchStrategy *FindBranchStrategy(const char *name)
+{
+    for (size_t i = 0; i < BRANCH_STRATEGY_COUNT; i++)
+        if (strcmp(branchStrategies[i].name, name) == 0) return &branchStrategies[i];
+    fprintf(stderr, "Unknown branching strategy '%s', expected one of:", name);
+    for (size_t i = 0; i < BRANCH_STRATEGY_COUNT; i++)
+        fprintf(stderr, " %s", branchStrategies[i].name);
+    fprintf(stderr, "\n");
+    return NULL;
+}
+
+typedef struct {
+    char *path;         /* level file, loaded by the worker; NULL for a grid read from stdin */
+    char *name;         /* NULL for a pack puzzle, see ItemName */
+    const Pack *pack;   /* puzzle packIndex of a pack, unpacked by the worker */
+    size_t packIndex;
+    uint8_t *result;    /* pack puzzle printed by the report: its solution, packed */
+    Game game;
+    int readError;      /* see ReadErrorString */
+    size_t status;      /* WIN, IMPOSSIBLE, NOT_FINISHED when the grid could not be read */
+    const char *check;
+    int mismatch;
+    size_t solutions;   /* count command */
+    uint64_t readNs;    /* loading the grid */
+    uint64_t elapsedNs; /* solving or counting */
+    uint64_t checkNs;   /* comparing with the expected solution and writing it out */
+    const char *winner; /* -R: the configuration that settled the grid */
+    SolverStats stats;
+} BatchItem;
+
+typedef struct {
+    const BranchStrategy *strategy;  /* NULL: DefaultStrategy of each grid's size */
+    BranchStrategy tuned;  /* a copy of the strategy with -P, -l and -r applied */
+    const char *outDir;  /* NULL: solutions go to stdout */
+    const char *jsonPath; /* per-grid counters and timings, one JSON object per line */
+    size_t workers;
+    int split;           /* workers share each grid's search tree instead of taking whole grids */
+    int race;            /* workers race different configurations on each grid, see SolveRace */
+    int counting;        /* count command: count solutions up to `limit` instead of solving */
+    size_t limit;
+    int print;           /* count command: stream every solution to stdout */
+    struct {
+        BatchItem *items;
+        size_t count;
+        size_t capacity;
+    } items;
+    struct {
+        Pack **items;    /* stable addresses, items point to them */
+        size_t count;
+        size_t capacity;
+    } packs;
+    Arena *arenas;       /* one per worker, reset for each grid */
+    size_t ttBytes;      /* transposition table per worker, 0 for none */
+    TransTable *tables;  /* one per worker, kept from one grid to the next */
+    uint8_t *results;    /* the `result` of every pack item, in one block */
+} BatchSolve;
+
+static const char *BaseName(const char *path)
+{
+    const char *slash = strrchr(path, '/');
+#ifdef _WIN32
+    const char *backslash = strrchr(path, '\\');
+    if (backslash > slash) slash = backslash;
+#endif
+    return slash ? slash + 1 : path;
+}
+
+/* Pack puzzles are named on demand: millions of them do not need a string each */
+static const char *ItemName(const BatchItem *item, char *buf, size_t len)
+{
+    if (!item->pack) return item->name;
+    snprintf(buf, len, "%s#%zu", item->pack->path, item->packIndex + 1);
+    return buf;
+}
+
+/* File name of puzzle k of a pack once unpacked: corpus.binpack -> corpus-<k+1>.binero */
+static void PackLevelName(const Pack *pack, size_t k, char *buf, size_t len)
+{
+    const char *base = BaseName(pack->path);
+    snprintf(buf, len, "%.*s-%zu.binero", (int)(strlen(base) - 8), base, k + 1);
+}
+
+/* Write a grid in the .binero format from the ones mask of each row, cells outside `shown`
+   (all of them when NULL) being left empty */
+static void WriteMaskGrid(FILE *f, size_t size, const Line *ones, const Line *shown)
+{
+    for (size_t i = 0; i < size; i++) {
+        for (size_t j = 0; j < size; j++) {
+            if (shown && !(shown[i] >> j & 1)) fputc(' ', f);
+            else fputc(ones[i] >> j & 1 ? '1' : '0', f);
+        }
+        if (i < size - 1) fputc('\n', f);
+    }
+}
+
+/* Same as WriteMaskGrid into a zeroed pack record */
+static void PackMaskGrid(uint8_t *record, size_t size, const Line *ones, const Line *shown)
+{
+    for (size_t i = 0; i < size; i++)
+        for (size_t j = 0; j < size; j++)
+            if (!shown || shown[i] >> j & 1)
+                SetPackedCell(record, i * size + j, ones[i] >> j & 1 ? '1' : '0');
+}
+
+/* Create DIR/NAME for writing. A failure, a path too long included, is reported on stderr and
+   gives NULL. */
+static FILE *CreateOutput(const char *dir, const char *name)
+{
+    char path[4096];
+    int len = snprintf(path, sizeof(path), "%s/%s", dir, name);
+    if (len < 0 || (size_t)len >= sizeof(path)) {
+        fprintf(stderr, "%s/%s: %s\n", dir, name, strerror(ENAMETOOLONG));
+        return NULL;
+    }
+    FILE *f = fopen(path, "wb");
+    if (!f) fprintf(stderr, "%s: %s\n", path, strerror(errno));
+    return f;
+}
+
+static void PrintBitSolution(const BitGame *bg, void *ctx)
+{
+    (void)ctx;
+    WriteMaskGrid(stdout, bg->size, bg->rows[1], NULL);
+    fputs("\n\n", stdout);
+}
+
+/* Runs on a pool worker: everything it touches belongs to its own item */
+static void BatchSolveItem(BatchSolve *batch, Arena *arena, TransTable *tt, BatchItem *item)
+{
+    if (item->readError) return;
+
+    uint64_t start = NowNs();
+    if (item->pack) {
+        item->game = InitGameIn(arena, item->pack->size);
+        UnpackGame(item->pack->puzzles + item->packIndex * item->pack->recordLen, &item->game);
+    }
+    else if (item->path) {
+        FILE *file = fopen(item->path, "rb");
+        if (!file) {
+            item->readError = errno;
+            return;
+        }
+        int read = ReadLevel(file, &item->game);
+        fclose(file);
+        if (read != 1) {
+            item->readError = read;
+            return;
+        }
+    }
+    item->readNs = NowNs() - start;
+
+    start = NowNs();
+    const BranchStrategy *strategy = batch->strategy ? batch->strategy : DefaultStrategy(item->game.size);
+    if (batch->counting) {
+        SolutionFn print = batch->print ? PrintBitSolution : NULL;
+        item->solutions = batch->split
+            ? CountSolutionsParallel(&item->game, strategy, batch->workers, batch->limit, print, NULL, &item->stats)
+            : CountSolutions(arena, tt, &item->game, strategy, batch->limit, print, NULL, &item->stats);
+        item->elapsedNs = NowNs() - start;
+        return;
+    }
+    if (batch->race)
+        item->status = SolveRace(&item->game, batch->workers, &item->stats, &item->winner);
+    else if (batch->split)
+        item->status = SolveParallel(&item->game, strategy, batch->workers, &item->stats);
+    else
+        item->status = Solve(arena, tt, &item->game, strategy, &item->stats);
+    item->elapsedNs = NowNs() - start;
+    if (item->status != WIN) return;
+
+    start = NowNs();
+    item->check = "";
+    if (item->pack && item->pack->solutions) {
+        const uint8_t *expected = item->pack->solutions + item->packIndex * item->pack->recordLen;
+        item->check = " solution ok";
+        for (size_t k = 0; k < item->game.size * item->game.size; k++) {
+            if (item->game.array[k].value != (PackedCell(expected, k) == 2 ? '1' : '0')) {
+                item->check = " SOLUTION MISMATCH";
+                item->mismatch = 1;
+                break;
+            }
+        }
+    }
+    else if (item->path) {
+        char solPath[4100];
+        snprintf(solPath, sizeof(solPath), "%s.sol", item->path);
+        char *expected = ReadSolution(solPath, item->game.size);
+        if (expected) {
+            item->check = " solution ok";
+            for (size_t i = 0; i < item->game.size * item->game.size; i++) {
+                if (item->game.array[i].value != expected[i]) {
+                    item->check = " SOLUTION MISMATCH";
+                    item->mismatch = 1;
+                    break;
+                }
+            }
+            free(expected);
+        }
+    }
+
+    if (batch->outDir) {
+        char name[512], path[4096];
+        if (item->pack) PackLevelName(item->pack, item->packIndex, name, sizeof(name));
+        else snprintf(name, sizeof(name), "%s", BaseName(item->name));
+        snprintf(path, sizeof(path), "%s/%s.sol", batch->outDir, name);
+        FILE *f = fopen(path, "wb");
+        if (f) {
+            WriteLevel(f, &item->game);
+            fclose(f);
+        }
+        else item->check = " (could not write the solution)";
+    }
+    item->checkNs = NowNs() - start;
+}
+
+static void BatchSolveTask(void *ctx, size_t worker, size_t task)
+{
+    BatchSolve *batch = ctx;
+    BatchItem *item = &batch->items.items[task];
+    Arena *arena = &batch->arenas[worker];
+    ArenaReset(arena);
+    BatchSolveItem(batch, arena, batch->tables ? &batch->tables[worker] : NULL, item);
+    /* A pack puzzle lives in the arena until the next reset: keep the solution packed */
+    if (item->pack) {
+        if (item->result && item->status == WIN) PackGame(&item->game, item->result);
+        item->game = (Game){0};
+    }
+}
+
+static void BatchAddPath(BatchSolve *batch, const char *path)
+{
+    if (strcmp(path, "-") == 0) {
+        /* stdin: any number of grids, blank lines between them are skipped */
+        for (size_t k = 1;; k++) {
+            char name[32];
+            snprintf(name, sizeof(name), "stdin-%zu.binero", k);
+            BatchItem item = { .name = strdup(name) };
+            int read = ReadLevel(stdin, &item.game);
+            if (read == 0) {
+                free(item.name);
+                FreeGame(&item.game);
+                return;
+            }
+            if (read < 0) item.readError = read;
+            da_append(&batch->items, item);
+            if (read < 0) return;
+        }
+    }
+
+    if (IsPackName(path)) {
+        Pack *pack = malloc(sizeof(Pack));
+        int err = OpenPack(path, pack);
+        if (err) {
+            free(pack);
+            BatchItem item = { .name = strdup(path), .readError = err };
+            da_append(&batch->items, item);
+            return;
+        }
+        da_append(&batch->packs, pack);
+        for (size_t k = 0; k < pack->count; k++) {
+            BatchItem item = { .pack = pack, .packIndex = k };
+            da_append(&batch->items, item);
+        }
+        return;
+    }
+
+    if (IsDirectory(path)) {
+        Paths paths = {0};
+        ListLevels(path, &paths);
+        nob_da_foreach(char*, it, &paths) BatchAddPath(batch, *it);
+        FreePaths(&paths);
+        return;
+    }
+
+    BatchItem item = { .path = strdup(path), .name = strdup(path) };
+    da_append(&batch->items, item);
+}
+
+static void PrintUsage(FILE *f)
+{
+    fprintf(f,
+        "Usage: binero                 interactive level menu\n"
+        "       binero solve [options] PATH...\n"
+        "       binero count [options] PATH...\n"
+        "       binero generate [options]\n"
+        "       binero pack -o FILE.binpack PATH...\n"
+        "       binero unpack [-o DIR] FILE.binpack...\n"
+        "       binero bench [options]\n"
+        "\n"
+        "PATH is a .binero file, a directory (all its .binero files), '-' for grids read from stdin\n"
+        "or, for solve and count, a .binpack corpus (puzzle k is reported as FILE.binpack#k).\n"
+        "\n"
+        "solve: solutions are printed to stdout in the .binero format, separated by a blank line.\n"
+        "  A report line per grid goes to stderr: status, solve time, nodes and, when\n"
+        "  <level>.binero.sol exists, whether the solution matches it.\n"
+        "  -o, --out DIR       write each solution to DIR/<level>.binero.sol instead of stdout\n"
+        "  -R, --race          process grids one at a time, racing one search configuration per\n"
+        "                      worker (up to 8: branching, value order, -P, -l, -r) on each and\n"
+        "                      reporting the first to finish; it cannot be combined with -b,\n"
+        "                      -P, -l, -r or -t\n"
+        "\n"
+        "count: count the solutions of each grid, by default up to 2 (uniqueness check).\n"
+        "  The exit status is 0 only if every grid has exactly one solution (with -n 1, at\n"
+        "  least one: uniqueness is then not checked).\n"
+        "  -n, --limit N       stop counting at N solutions, 0 for no limit\n"
+        "  -p, --print         stream every solution found to stdout (one grid at a time)\n"
+        "\n"
+        "generate: build random puzzles with a unique solution and no removable clue.\n"
+        "  Puzzles are printed to stdout separated by a blank line; the rate goes to stderr.\n"
+        "  -n, --count N       number of puzzles, default 1\n"
+        "  -z, --size N        grid size (even, 4 to 64), default 14; past 16 a clue whose check\n"
+        "                      takes over 50 nodes is kept, so puzzles are unique but may not\n"
+        "                      be minimal (one 64x64 puzzle takes about 20 s)\n"
+        "  -r, --seed S        seed, default taken from the clock (and reported)\n"
+        "  -o, --out DIR       write DIR/gen-<seed>-<k>.binero and its .binero.sol instead\n"
+        "  -o, --out FILE.binpack  or write all of them, with their solutions, to a pack\n"
+        "  -b, --branch NAME   branching strategy of the uniqueness checks, default line\n"
+        "  -j, --jobs N        worker threads, default one per core\n"
+        "\n"
+        "pack: convert grids of one size into a .binpack corpus, 2 bits per cell, with their\n"
+        "  solutions if every grid has a <level>.binero.sol.\n"
+        "unpack: print the puzzles of a pack as a .binero stream, or with -o write\n"
+        "  DIR/<pack>-<k>.binero and, if the pack has them, their solutions.\n"
+        "\n"
+        "bench: time evident solve, solve and win check call by call on one thread over a seeded\n"
+        "  corpus (6x6 to 16x16, minimal and easy puzzles) and the levels directory; prints\n"
+        "  calls/s and p50/p99/max latency per set.\n"
+        "  -r, --seed S        corpus seed, default 1\n"
+        "  -n, --rounds N      passes over the corpus, default 3\n"
+        "  -z, --max-size N    leave out the larger sizes\n"
+        "  -c, --corpus DIR    read the corpus from DIR/bench-<seed>-*.binpack, generating and\n"
+        "                      saving it there first if missing, so that it never changes\n"
+        "  -L, --levels DIR    levels to add, default levels ('' for none)\n"
+        "  -w, --write FILE    save the results as a baseline\n"
+        "  -B, --baseline FILE compare each p50 with FILE; exit status 1 if one is slower\n"
+        "  -T, --tolerance PCT by more than PCT percent, default 10\n"
+        "\n"
+        "common options:\n"
+        "  -b, --branch NAME   branching strategy (first, line, quota, probe), default first up\n"
+        "                      to 16x16 and, above, quota with -l 2000 -r 100 (count: quota)\n"
+        "  -j, --jobs N        worker threads, default one per core\n"
+        "  -s, --split         process grids one at a time, splitting each search tree across\n"
+        "                      the workers (for a few very hard grids); not with -t, -l or -r\n"
+        "  -J, --json FILE     solve and count: write one JSON object per grid to FILE ('-' for\n"
+        "                      stdout) with timings in ns, nodes, depth and per-rule counters\n"
+        "  -t, --tt MB         solve and count: cache dead and counted partial grids in a table of\n"
+        "                      MB megabytes per worker, kept across grids (default 0: none)\n"
+        "  -P, --lookahead     solve and count: before each branch, try both values of every empty\n"
+        "                      cell and fix those that fail or that both values agree on\n"
+        "  -l, --learn N       solve: learn a nogood from each conflict and backjump, keeping at\n"
+        "                      most N of them (default 0: plain backtracking)\n"
+        "  -r, --restart N     solve: cut each run at N * Luby(k) nodes and start over with a new\n"
+        "                      random value order, keeping the nogoods (default 0: a single run)\n");
+}
+
+/* Parse the options, load the inputs and run every grid on the pool. Returns 0, or 2 on a
+   usage error. */
+static int RunBatch(BatchSolve *batch, int argc, char **argv)
+{
+    int firstPath = argc;
+    for (int i = 0; i < argc; i++) {
+        if ((strcmp(argv[i], "-b") == 0 || strcmp(argv[i], "--branch") == 0) && i + 1 < argc) {
+            if (!(batch->strategy = FindBranchStrategy(argv[++i]))) return 2;
+        }
+        else if (!batch->counting && (strcmp(argv[i], "-o") == 0 || strcmp(argv[i], "--out") == 0) && i + 1 < argc) {
+            batch->outDir = argv[++i];
+        }
+        else if (batch->counting && (strcmp(argv[i], "-n") == 0 || strcmp(argv[i], "--limit") == 0) && i + 1 < argc) {
+            batch->limit = strtoul(argv[++i], NULL, 10);
+        }
+        else if (batch->counting && (strcmp(argv[i], "-p") == 0 || strcmp(argv[i], "--print") == 0)) {
+            batch->print = 1;
+        }
+        else if ((strcmp(argv[i], "-j") == 0 || strcmp(argv[i], "--jobs") == 0) && i + 1 < argc) {
+            batch->workers = strtoul(argv[++i], NULL, 10);
+            if (batch->workers == 0) batch->workers = 1;
+        }
+        else if (strcmp(argv[i], "-s") == 0 || strcmp(argv[i], "--split") == 0) {
+            batch->split = 1;
+        }
+        else if (!batch->counting && (strcmp(argv[i], "-R") == 0 || strcmp(argv[i], "--race") == 0)) {
+            batch->race = 1;
+        }
+        else if ((strcmp(argv[i], "-J") == 0 || strcmp(argv[i], "--json") == 0) && i + 1 < argc) {
+            batch->jsonPath = argv[++i];
+        }
+        else if ((strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "--tt") == 0) && i + 1 < argc) {
+            batch->ttBytes = strtoul(argv[++i], NULL, 10) << 20;
+        }
+        else if (strcmp(argv[i], "-P") == 0 || strcmp(argv[i], "--lookahead") == 0) {
+            batch->tuned.lookahead = 1;
+        }
+        else if (!batch->counting && (strcmp(argv[i], "-l") == 0 || strcmp(argv[i], "--learn") == 0) && i + 1 < argc) {
+            batch->tuned.learn = strtoul(argv[++i], NULL, 10);
+        }
+        else if (!batch->counting && (strcmp(argv[i], "-r") == 0 || strcmp(argv[i], "--restart") == 0) && i + 1 < argc) {
+            batch->tuned.restart = strtoul(argv[++i], NULL, 10);
+        }
+        else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+            PrintUsage(stderr);
+            return 2;
+        }
+        else { firstPath = i; break; }
+    }
+    if (firstPath == argc) {
+        PrintUsage(stderr);
+        return 2;
+    }
+    /* The split search and the race run on solvers of their own, which would drop these */
+    if ((batch->split || batch->race) && (batch->ttBytes || batch->tuned.learn || batch->tuned.restart)) {
+        fprintf(stderr, "-t, -l and -r cannot be combined with %s\n", batch->race ? "-R" : "-s");
+        return 2;
+    }
+    if (batch->race && (batch->strategy || batch->tuned.lookahead)) {
+        fprintf(stderr, "-R picks its own configurations: -b and -P cannot be combined with it\n");
+        return 2;
+    }
+    if (batch->tuned.lookahead || batch->tuned.learn || batch->tuned.restart) {
+        if (!batch->strategy) batch->strategy = &branchStrategies[0];
+        batch->tuned.name = batch->strategy->name;
+        batch->tuned.pick = batch->strategy->pick;
+        batch->strategy = &batch->tuned;
+    }
+
+    for (int i = firstPath; i < argc; i++)
+        BatchAddPath(batch, argv[i]);
+
+    /* Nothing is allocated per grid from here on, except to read .binero files */
+    if (!batch->counting && !batch->outDir) {
+        size_t bytes = 0;
+        nob_da_foreach(BatchItem, item, &batch->items)
+            if (item->pack) bytes += item->pack->recordLen;
+        if (bytes && !(batch->results = malloc(bytes))) {
+            perror("malloc");
+            exit(EXIT_FAILURE);
+        }
+        bytes = 0;
+        nob_da_foreach(BatchItem, item, &batch->items) {
+            if (!item->pack) continue;
+            item->result = batch->results + bytes;
+            bytes += item->pack->recordLen;
+        }
+    }
+    batch->arenas = malloc(batch->workers * sizeof(Arena));
+    if (!batch->arenas) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t w = 0; w < batch->workers; w++) batch->arenas[w] = InitArena(ARENA_DEFAULT_SIZE);
+    if (batch->ttBytes) {
+        if (!(batch->tables = malloc(batch->workers * sizeof(TransTable)))) {
+            perror("malloc");
+            exit(EXIT_FAILURE);
+        }
+        for (size_t w = 0; w < batch->workers; w++) batch->tables[w] = InitTransTable(batch->ttBytes);
+    }
+
+    /* Streamed solutions must not interleave: grids then go one at a time */
+    RunTasks(batch->split || batch->race || batch->print ? 1 : batch->workers, batch->items.count, BatchSolveTask, batch);
+    return 0;
+}
+
+static void FreeBatch(BatchSolve *batch)
+{
+    nob_da_foreach(BatchItem, item, &batch->items) {
+        free(item->path);
+        free(item->name);
+        FreeGame(&item->game);
+    }
+    da_free(&batch->items);
+    nob_da_foreach(Pack*, pack, &batch->packs) {
+        ClosePack(*pack);
+        free(*pack);
+    }
+    da_free(&batch->packs);
+    for (size_t w = 0; batch->arenas && w < batch->workers; w++) FreeArena(&batch->arenas[w]);
+    free(batch->arenas);
+    for (size_t w = 0; batch->tables && w < batch->workers; w++) FreeTransTable(&batch->tables[w]);
+    free(batch->tables);
+    free(batch->results);
+}
+
+static void WriteJsonString(FILE *f, const char *str)
+{
+    fputc('"', f);
+    for (const unsigned char *c = (const unsigned char *)str; *c; c++) {
+        if (*c == '"' || *c == '\\') fprintf(f, "\\%c", *c);
+        else if (*c < 0x20) fprintf(f, "\\u%04x", *c);
+        else fputc(*c, f);
+    }
+    fputc('"', f);
+}
+
+/* The --json dump: one object per grid, in input order */
+static void WriteBatchJson(const BatchSolve *batch)
+{
+    if (!batch->jsonPath) return;
+    FILE *f = strcmp(batch->jsonPath, "-") == 0 ? stdout : fopen(batch->jsonPath, "wb");
+    if (!f) {
+        fprintf(stderr, "%s: %s\n", batch->jsonPath, strerror(errno));
+        return;
+    }
+    nob_da_foreach(BatchItem, item, &batch->items) {
+        char name[4200];
+        fputs("{\"name\":", f);
+        WriteJsonString(f, ItemName(item, name, sizeof(name)));
+        if (item->readError) {
+            fputs(",\"error\":", f);
+            WriteJsonString(f, ReadErrorString(item->readError));
+            fputs("}\n", f);
+            continue;
+        }
+        const SolverStats *st = &item->stats;
+        if (batch->counting) fprintf(f, ",\"solutions\":%zu", item->solutions);
+        else fprintf(f, ",\"status\":\"%s\"", item->status == WIN ? "solved" : "unsolvable");
+        if (item->winner) {
+            fputs(",\"winner\":", f);
+            WriteJsonString(f, item->winner);
+        }
+        fprintf(f, ",\"size\":%zu,\"read_ns\":%llu,\"solve_ns\":%llu,\"propagate_ns\":%llu"
+                   ",\"branch_ns\":%llu,\"check_ns\":%llu",
+                item->pack ? item->pack->size : item->game.size,
+                (unsigned long long)item->readNs, (unsigned long long)item->elapsedNs,
+                (unsigned long long)st->propagateNs, (unsigned long long)st->branchNs,
+                (unsigned long long)item->checkNs);
+        fprintf(f, ",\"nodes\":%zu,\"backtracks\":%zu,\"max_depth\":%zu,\"tt_hits\":%zu,\"tt_misses\":%zu"
+                   ",\"probes\":%zu,\"probe_fixed\":%zu,\"probe_ns\":%llu,\"learned\":%zu,\"jumped\":%zu"
+                   ",\"nogood_fixed\":%zu,\"restarts\":%zu,\"passes\":%zu,\"lines\":%zu",
+                st->nodes, st->backtracks, st->maxDepth, st->ttHits, st->ttMisses, st->probes, st->probeFixed,
+                (unsigned long long)st->probeNs, st->learned, st->jumped, st->nogoodFixed, st->restarts,
+                st->prop.passes, st->prop.lines);
+        fputs(",\"rules\":{", f);
+        for (size_t r = 0; r < LINE_RULE_COUNT; r++)
+            fprintf(f, "%s\"%s\":{\"calls\":%zu,\"cells\":%zu}", r ? "," : "", lineRuleNames[r],
+                    st->prop.ruleCalls[r], st->prop.ruleCells[r]);
+        fputs("}}\n", f);
+    }
+    if (f == stdout) fflush(f);
+    else if (fclose(f) != 0) fprintf(stderr, "%s: %s\n", batch->jsonPath, strerror(errno));
+}
+
+static int ReportReadError(const BatchItem *item)
+{
+    if (!item->readError) return 0;
+    char name[4200];
+    fprintf(stderr, "%s: %s\n", ItemName(item, name, sizeof(name)), ReadErrorString(item->readError));
+    return 1;
+}
+
+static int SolveCommand(int argc, char **argv)
+{
+    BatchSolve batch = { .workers = CpuCount() };
+    uint64_t start = NowNs();
+    int usage = RunBatch(&batch, argc, argv);
+    if (usage) return usage;
+    uint64_t wall = NowNs() - start;
+
+    /* Reports and solutions come out in input order, whatever order the workers finished in */
+    size_t solved = 0, unsolvable = 0, errors = 0, mismatches = 0;
+    size_t wins[RACE_ENTRY_COUNT] = {0};
+    uint64_t solveNs = 0;
+    nob_da_foreach(BatchItem, item, &batch.items) {
+        if (ReportReadError(item)) {
+            errors++;
+            continue;
+        }
+        if (item->status == WIN) {
+            solved++;
+            mismatches += (size_t)item->mismatch;
+            if (!batch.outDir) {
+                Game shown = item->game;
+                if (item->pack) {
+                    ArenaReset(&batch.arenas[0]);
+                    shown = InitGameIn(&batch.arenas[0], item->pack->size);
+                    UnpackGame(item->result, &shown);
+                }
+                WriteLevel(stdout, &shown);
+                fputs("\n\n", stdout);
             }
-        } while (count < 64 && FindNextFileA(hFind, &ffd));
-        FindClose(hFind);
+        }
+        else unsolvable++;
+        solveNs += item->elapsedNs;
+        for (size_t k = 0; k < RACE_ENTRY_COUNT; k++)
+            wins[k] += item->winner == raceEntries[k].name;
+        char name[4200];
+        fprintf(stderr, "%s: %s %.3f ms %zu nodes%s%s%s\n", ItemName(item, name, sizeof(name)),
+                item->status == WIN ? "solved" : "unsolvable",
+                (double)item->elapsedNs / 1e6, item->stats.nodes, item->winner ? " by " : "",
+                item->winner ? item->winner : "", item->status == WIN ? item->check : "");
     }
-#else
-    DIR *dir = opendir(levelsDir);
-    if (dir) {
-        struct dirent *ent;
-        while ((ent = readdir(dir)) != NULL && count < 64) {
-            size_t len = strlen(ent->d_name);
-            if (len > 7 && strcmp(ent->d_name + len - 7, ".binero") == 0
-                && strcmp(ent->d_name + len - 11, ".binero.sol") != 0) {
-                snprintf(paths[count], sizeof(paths[count]), "%s/%s", levelsDir, ent->d_name);
-                count++;
+    if (batch.race) {
+        fputs("wins:", stderr);
+        for (size_t k = 0; k < RACE_ENTRY_COUNT && k < batch.workers; k++)
+            fprintf(stderr, "%s %s %zu", k ? "," : "", raceEntries[k].name, wins[k]);
+        fputc('\n', stderr);
+    }
+    WriteBatchJson(&batch);
+    FreeBatch(&batch);
+
+    fprintf(stderr, "%zu solved, %zu unsolvable, %zu errors, %zu mismatches in %.3f ms (%.3f ms solving, %zu threads)\n",
+            solved, unsolvable, errors, mismatches, (double)wall / 1e6, (double)solveNs / 1e6, batch.workers);
+    return unsolvable || errors || mismatches ? 1 : 0;
+}
+
+static int CountCommand(int argc, char **argv)
+{
+    BatchSolve batch = { .workers = CpuCount(), .counting = 1, .limit = 2 };
+    uint64_t start = NowNs();
+    int usage = RunBatch(&batch, argc, argv);
+    if (usage) return usage;
+    uint64_t wall = NowNs() - start;
+
+    size_t unique = 0, solvable = 0, none = 0, multiple = 0, errors = 0;
+    nob_da_foreach(BatchItem, item, &batch.items) {
+        if (ReportReadError(item)) {
+            errors++;
+            continue;
+        }
+        char verdict[64];
+        if (item->solutions == 0) {
+            snprintf(verdict, sizeof(verdict), "no solution");
+            none++;
+        }
+        else if (batch.limit == 1) {
+            /* Stopped at the first solution: a second one was never looked for */
+            snprintf(verdict, sizeof(verdict), "solvable (uniqueness not checked)");
+            solvable++;
+        }
+        else if (item->solutions == 1) {
+            snprintf(verdict, sizeof(verdict), "unique");
+            unique++;
+        }
+        else {
+            if (item->solutions == batch.limit)
+                snprintf(verdict, sizeof(verdict), "at least %zu solutions", item->solutions);
+            else
+                snprintf(verdict, sizeof(verdict), "%zu solutions", item->solutions);
+            multiple++;
+        }
+        char name[4200];
+        fprintf(stderr, "%s: %s %.3f ms %zu nodes\n", ItemName(item, name, sizeof(name)), verdict,
+                (double)item->elapsedNs / 1e6, item->stats.nodes);
+    }
+    WriteBatchJson(&batch);
+    FreeBatch(&batch);
+
+    if (batch.limit == 1)
+        fprintf(stderr, "%zu solvable (uniqueness not checked), %zu without solution, %zu errors in %.3f ms\n",
+                solvable, none, errors, (double)wall / 1e6);
+    else
+        fprintf(stderr, "%zu unique, %zu without solution, %zu with several, %zu errors in %.3f ms\n",
+                unique, none, multiple, errors, (double)wall / 1e6);
+    return none || multiple || errors ? 1 : 0;
+}
+
+typedef struct {
+    size_t size;
+    uint64_t seed;
+    Solver *solvers;    /* one per worker, reused for every puzzle it builds */
+    Learner *learners;  /* past 16x16: one per worker, for its solver */
+    Puzzle *puzzles;
+    const char *outDir;
+    atomic_size_t errors; /* files that could not be written */
+} Generator;
+
+static void GenerateTask(void *ctx, size_t worker, size_t task)
+{
+    Generator *gen = ctx;
+    /* Each puzzle has its own seed, so the output does not depend on the scheduling */
+    uint64_t seed = gen->seed ^ (task * 0xD1B54A32D192ED03ull);
+    Puzzle *p = &gen->puzzles[task];
+    GeneratePuzzle(&gen->solvers[worker], NextRandom(&seed), p);
+
+    if (gen->outDir && !IsPackName(gen->outDir)) {
+        char name[128];
+        for (int sol = 0; sol <= 1; sol++) {
+            snprintf(name, sizeof(name), "gen-%llu-%zu.binero%s", (unsigned long long)gen->seed, task + 1,
+                     sol ? ".sol" : "");
+            FILE *f = CreateOutput(gen->outDir, name);
+            if (!f) {
+                atomic_fetch_add(&gen->errors, 1);
+                continue;
             }
+            WriteMaskGrid(f, gen->size, p->solution, sol ? NULL : p->clues);
+            fclose(f);
         }
-        closedir(dir);
     }
-#endif
+}
 
-    /* Sort alphabetically */
-    for (size_t i = 0; i < count; i++)
-        for (size_t j = i + 1; j < count; j++)
-            if (strcmp(paths[i], paths[j]) > 0) {
-                char tmp[256];
-                memcpy(tmp, paths[i], 256);
-                memcpy(paths[i], paths[j], 256);
-                memcpy(paths[j], tmp, 256);
+static int GenerateCommand(int argc, char **argv)
+{
+    Generator gen = { .size = 14, .seed = NowNs() };
+    size_t count = 1, workers = CpuCount();
+    /* Most checks are single satisfiability probes: cheap line branching wins */
+    const BranchStrategy *strategy = FindBranchStrategy("line");
+    for (int i = 0; i < argc; i++) {
+        if ((strcmp(argv[i], "-b") == 0 || strcmp(argv[i], "--branch") == 0) && i + 1 < argc) {
+            if (!(strategy = FindBranchStrategy(argv[++i]))) return 2;
+        }
+        else if ((strcmp(argv[i], "-n") == 0 || strcmp(argv[i], "--count") == 0) && i + 1 < argc)
+            count = strtoul(argv[++i], NULL, 10);
+        else if ((strcmp(argv[i], "-z") == 0 || strcmp(argv[i], "--size") == 0) && i + 1 < argc)
+            gen.size = strtoul(argv[++i], NULL, 10);
+        else if ((strcmp(argv[i], "-r") == 0 || strcmp(argv[i], "--seed") == 0) && i + 1 < argc)
+            gen.seed = strtoull(argv[++i], NULL, 10);
+        else if ((strcmp(argv[i], "-o") == 0 || strcmp(argv[i], "--out") == 0) && i + 1 < argc)
+            gen.outDir = argv[++i];
+        else if ((strcmp(argv[i], "-j") == 0 || strcmp(argv[i], "--jobs") == 0) && i + 1 < argc) {
+            workers = strtoul(argv[++i], NULL, 10);
+            if (workers == 0) workers = 1;
+        }
+        else {
+            PrintUsage(stderr);
+            return 2;
+        }
+    }
+    if (gen.size < 4 || gen.size > BIT_MAX_SIZE || gen.size % 2) {
+        fprintf(stderr, "Grid size must be even, from 4 to %d\n", BIT_MAX_SIZE);
+        return 2;
+    }
+
+    if (workers > count) workers = count ? count : 1;
+    gen.solvers = calloc(workers, sizeof(Solver));
+    gen.learners = calloc(workers, sizeof(Learner));
+    gen.puzzles = malloc(count * sizeof(Puzzle));
+    if (!gen.solvers || !gen.learners || (count && !gen.puzzles)) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t w = 0; w < workers; w++) {
+        gen.solvers[w] = (Solver){ .bg = InitBitGame(NULL, gen.size), .strategy = strategy };
+        if (DefaultStrategy(gen.size)->learn) {
+            gen.learners[w] = InitLearner(NULL, gen.size, DefaultStrategy(gen.size)->learn);
+            gen.solvers[w].learn = &gen.learners[w];
+        }
+    }
+
+    uint64_t start = NowNs();
+    RunTasks(workers, count, GenerateTask, &gen);
+    uint64_t wall = NowNs() - start;
+
+    size_t clues = 0, recordLen = gen.size * gen.size / 4;
+    int packed = gen.outDir && IsPackName(gen.outDir);
+    Bytes puzzles = {0}, solutions = {0};
+    for (size_t k = 0; k < count; k++) {
+        Puzzle *p = &gen.puzzles[k];
+        clues += p->clueCount;
+        if (packed) {
+            PackMaskGrid(AppendRecord(&puzzles, recordLen), gen.size, p->solution, p->clues);
+            PackMaskGrid(AppendRecord(&solutions, recordLen), gen.size, p->solution, NULL);
+        }
+        else if (!gen.outDir) {
+            WriteMaskGrid(stdout, gen.size, p->solution, p->clues);
+            fputs("\n\n", stdout);
+        }
+    }
+    int err = packed ? WritePack(gen.outDir, gen.size, &puzzles, &solutions) : 0;
+    if (err) fprintf(stderr, "%s: %s\n", gen.outDir, strerror(err));
+    free(puzzles.items);
+    free(solutions.items);
+    fprintf(stderr, "%zu puzzles %zux%zu (seed %llu) in %.3f ms: %.1f puzzles/s, %.1f clues on average, %zu threads\n",
+            count, gen.size, gen.size, (unsigned long long)gen.seed, (double)wall / 1e6,
+            wall ? (double)count * 1e9 / (double)wall : 0.0, count ? (double)clues / (double)count : 0.0, workers);
+    size_t unwritten = atomic_load(&gen.errors);
+    if (unwritten) fprintf(stderr, "%zu files could not be written\n", unwritten);
+
+    for (size_t w = 0; w < workers; w++) {
+        FreeBitGame(&gen.solvers[w].bg);
+        FreeLearner(&gen.learners[w]);
+    }
+    free(gen.solvers);
+    free(gen.learners);
+    free(gen.puzzles);
+    return err || unwritten ? 1 : 0;
+}
+
+/* Convert .binero grids (files, directories, '-' for a stream on stdin) into one .binpack.
+   The solutions section is written when every grid comes with a valid <level>.binero.sol. */
+static int PackCommand(int argc, char **argv)
+{
+    const char *out = NULL;
+    int firstPath = argc;
+    for (int i = 0; i < argc; i++) {
+        if ((strcmp(argv[i], "-o") == 0 || strcmp(argv[i], "--out") == 0) && i + 1 < argc)
+            out = argv[++i];
+        else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+            PrintUsage(stderr);
+            return 2;
+        }
+        else { firstPath = i; break; }
+    }
+    if (!out || firstPath == argc) {
+        PrintUsage(stderr);
+        return 2;
+    }
+
+    Paths paths = {0};
+    for (int i = firstPath; i < argc; i++) {
+        if (IsDirectory(argv[i])) ListLevels(argv[i], &paths);
+        else da_append(&paths, strdup(argv[i]));
+    }
+
+    Bytes puzzles = {0}, solutions = {0};
+    size_t size = 0, count = 0, solved = 0, errors = 0;
+    Game game = {0};
+    nob_da_foreach(char*, it, &paths) {
+        int stream = strcmp(*it, "-") == 0;
+        FILE *f = stream ? stdin : fopen(*it, "rb");
+        if (!f) {
+            fprintf(stderr, "%s: %s\n", *it, strerror(errno));
+            errors++;
+            continue;
+        }
+        int read;
+        while ((read = ReadLevel(f, &game)) == 1) {
+            if (!size) size = game.size;
+            if (game.size != size) {
+                fprintf(stderr, "%s: %zux%zu grid in a %zux%zu pack\n", *it, game.size, game.size, size, size);
+                errors++;
             }
+            else {
+                size_t recordLen = size * size / 4;
+                PackGame(&game, AppendRecord(&puzzles, recordLen));
+                count++;
 
-    /* Interactive arrow-key menu */
-    enableRawMode();
-    int sel = 0, prev_sel = -1;
-    int total_items = (int)count + 1; /* levels + empty grid */
+                char solPath[4100];
+                snprintf(solPath, sizeof(solPath), "%s.sol", *it);
+                char *solution = stream ? NULL : ReadSolution(solPath, size);
+                size_t k = 0;
+                while (solution && k < size * size && (solution[k] == '0' || solution[k] == '1')) k++;
+                if (solution && k == size * size) {
+                    uint8_t *record = AppendRecord(&solutions, recordLen);
+                    for (k = 0; k < size * size; k++) SetPackedCell(record, k, solution[k]);
+                    solved++;
+                }
+                free(solution);
+            }
+            if (!stream) break; /* one grid per file */
+        }
+        if (read < 0) {
+            fprintf(stderr, "%s: %s\n", *it, ReadErrorString(read));
+            errors++;
+        }
+        if (!stream) fclose(f);
+    }
+    FreeGame(&game);
+    FreePaths(&paths);
 
-    /* Draw once */
-    printf("\x1b[H\x1b[2J\x1b[?25l"); /* clear + hide cursor */
-    printf("=== BINERO ===\r\n\r\n");
-    for (size_t i = 0; i < count; i++)
-        printf("  %zu) %s\r\n", i + 1, paths[i]);
-    printf("  0) Grille vide 14x14\r\n");
-    printf("\r\nFleches: haut/bas | Entree: valider\r\n");
+    int err = count ? WritePack(out, size, &puzzles, solved == count ? &solutions : NULL) : 0;
+    if (err) fprintf(stderr, "%s: %s\n", out, strerror(err));
+    else if (!count) fprintf(stderr, "%s: no grid to pack\n", out);
+    else fprintf(stderr, "%zu puzzles %zux%zu packed into %s (%zu bytes), %s\n", count, size, size, out,
+                 PACK_HEADER_SIZE + puzzles.count + (solved == count ? solutions.count : 0),
+                 solved == count ? "with their solutions" : solved ? "solutions left out: some are missing" : "no solutions");
+    free(puzzles.items);
+    free(solutions.items);
+    return err || errors || !count ? 1 : 0;
+}
 
-    for (;;) {
-        /* Update only changed lines */
-        if (prev_sel != sel) {
-            if (prev_sel >= 0) {
-                /* Unhighlight previous (menu items start at row 3) */
-                printf("\x1b[%d;1H\x1b[2K", prev_sel + 3);
-                if (prev_sel < (int)count)
-                    printf("  %d) %s", prev_sel + 1, paths[prev_sel]);
-                else
-                    printf("  0) Grille vide 14x14");
+/* Convert .binpack files back: a stream on stdout, or DIR/<pack>-<k>.binero and its .sol */
+static int UnpackCommand(int argc, char **argv)
+{
+    const char *outDir = NULL;
+    int firstPath = argc;
+    for (int i = 0; i < argc; i++) {
+        if ((strcmp(argv[i], "-o") == 0 || strcmp(argv[i], "--out") == 0) && i + 1 < argc)
+            outDir = argv[++i];
+        else if (argv[i][0] == '-') {
+            PrintUsage(stderr);
+            return 2;
+        }
+        else { firstPath = i; break; }
+    }
+    if (firstPath == argc) {
+        PrintUsage(stderr);
+        return 2;
+    }
+
+    size_t errors = 0;
+    for (int i = firstPath; i < argc; i++) {
+        Pack pack;
+        int err = OpenPack(argv[i], &pack);
+        if (err) {
+            fprintf(stderr, "%s: %s\n", argv[i], ReadErrorString(err));
+            errors++;
+            continue;
+        }
+        Game game = InitGame(pack.size);
+        for (size_t k = 0; k < pack.count; k++) {
+            UnpackGame(pack.puzzles + k * pack.recordLen, &game);
+            if (!outDir) {
+                WriteLevel(stdout, &game);
+                fputs("\n\n", stdout);
+                continue;
             }
-            /* Highlight current */
-            printf("\x1b[%d;1H\x1b[2K", sel + 3);
-            if (sel < (int)count)
-                printf("  " BG_WHITE "%d) %s" RESET, sel + 1, paths[sel]);
-            else
-                printf("  " BG_WHITE "0) Grille vide 14x14" RESET);
+            char name[512];
+            PackLevelName(&pack, k, name, sizeof(name));
+            FILE *f = CreateOutput(outDir, name);
+            if (!f) {
+                errors++;
+                break;
+            }
+            WriteLevel(f, &game);
+            fclose(f);
+            if (!pack.solutions) continue;
+            UnpackGame(pack.solutions + k * pack.recordLen, &game);
+            char solName[sizeof(name) + 4];
+            snprintf(solName, sizeof(solName), "%s.sol", name);
+            if (!(f = CreateOutput(outDir, solName))) {
+                errors++;
+                break;
+            }
+            WriteLevel(f, &game);
+            fclose(f);
+        }
+        fprintf(stderr, "%s: %zu puzzles %zux%zu%s\n", argv[i], pack.count, pack.size, pack.size,
+                pack.solutions ? " with their solutions" : "");
+        FreeGame(&game);
+        ClosePack(&pack);
+    }
+    return errors ? 1 : 0;
+}
 
-            prev_sel = sel;
+/* Benchmark: EvidentSolve, Solve and checkWin timed call by call over a fixed corpus of generated
+   puzzles of several sizes, minimal or with half of the clues the generator removed given back,
+   plus the levels directory. The corpus only depends on the seed, but the generator follows the
+   solver's search order: with -c it is kept in packs, so later runs time the very same grids. */
+static const struct { size_t size, count; } benchSizes[] = {
+    { 6, 200 }, { 8, 200 }, { 10, 100 }, { 12, 50 }, { 14, 40 }, { 16, 10 },
+};
+
+typedef struct {
+    char name[32];
+    Game *puzzles;
+    Game *solutions;      /* size 0: the puzzle has none, it is left out of the check */
+    size_t count;
+    size_t capacity;
+    uint64_t fingerprint; /* of the puzzles, so a baseline is only compared on the same grids */
+} BenchSet;
+
+typedef struct {
+    BenchSet *items;
+    size_t count;
+    size_t capacity;
+} BenchSets;
+
+enum { BENCH_EVIDENT, BENCH_SOLVE, BENCH_CHECK, BENCH_OP_COUNT };
+static const char *const benchOps[BENCH_OP_COUNT] = { "evident", "solve", "check" };
+
+typedef struct {
+    char set[32];
+    char op[16];
+    uint64_t fingerprint;
+    size_t calls;
+    double rate;              /* calls per second */
+    uint64_t p50, p99, max;   /* ns */
+} BenchResult;
+
+typedef struct {
+    BenchResult *items;
+    size_t count;
+    size_t capacity;
+} BenchResults;
+
+/* Takes ownership of both games */
+static void BenchAddGrid(BenchSet *set, Game puzzle, Game solution)
+{
+    if (set->count == set->capacity) {
+        set->capacity = set->capacity ? 2 * set->capacity : 64;
+        set->puzzles = realloc(set->puzzles, set->capacity * sizeof(Game));
+        set->solutions = realloc(set->solutions, set->capacity * sizeof(Game));
+        if (!set->puzzles || !set->solutions) {
+            perror("realloc");
+            exit(EXIT_FAILURE);
         }
-        fflush(stdout);
+    }
+    set->puzzles[set->count] = puzzle;
+    set->solutions[set->count] = solution;
+    set->count++;
+    /* FNV-1a */
+    if (!set->fingerprint) set->fingerprint = 0xCBF29CE484222325ull;
+    set->fingerprint = (set->fingerprint ^ puzzle.size) * 0x100000001B3ull;
+    for (size_t k = 0; k < puzzle.size * puzzle.size; k++)
+        set->fingerprint = (set->fingerprint ^ (uint8_t)puzzle.array[k].value) * 0x100000001B3ull;
+}
 
-        char c;
-#ifdef _WIN32
-        c = (char)_getch();
-        if (c == 0 || c == (char)0xe0) {
-            char c2 = (char)_getch();
-            if      (c2 == 72 && sel > 0)              sel--;  /* up */
-            else if (c2 == 80 && sel < total_items - 1) sel++; /* down */
+static void BenchAddRecords(BenchSet *set, size_t size, const uint8_t *puzzles, const uint8_t *solutions, size_t count)
+{
+    for (size_t k = 0; k < count; k++) {
+        Game puzzle = InitGame(size), solution = InitGame(size);
+        UnpackGame(puzzles + k * size * size / 4, &puzzle);
+        UnpackGame(solutions + k * size * size / 4, &solution);
+        BenchAddGrid(set, puzzle, solution);
+    }
+}
+
+static void FreeBenchSet(BenchSet *set)
+{
+    for (size_t k = 0; k < set->count; k++) {
+        FreeGame(&set->puzzles[k]);
+        FreeGame(&set->solutions[k]);
+    }
+    free(set->puzzles);
+    free(set->solutions);
+}
+
+/* The minimal and easy sets of one size: read from corpusDir when it has them, generated (and
+   saved there, when given) otherwise */
+static void BenchLoadSize(BenchSets *sets, size_t size, size_t count, uint64_t seed, const char *corpusDir, size_t workers)
+{
+    static const char *const kinds[2] = { "minimal", "easy" };
+    char paths[2][4096];
+    Pack packs[2];
+    for (int d = 0; d < 2; d++)
+        snprintf(paths[d], sizeof(paths[d]), "%s/bench-%llu-%zu-%s.binpack", corpusDir ? corpusDir : ".",
+                 (unsigned long long)seed, size, kinds[d]);
+    int loaded = corpusDir != NULL;
+    for (int d = 0; d < 2 && loaded; d++) {
+        if (OpenPack(paths[d], &packs[d]) == 0 && packs[d].solutions && packs[d].size == size) continue;
+        ClosePack(&packs[d]);
+        if (d == 1) ClosePack(&packs[0]);
+        loaded = 0;
+    }
+
+    Bytes puzzles[2] = {{0}}, solutions = {0};
+    if (!loaded) {
+        Generator gen = { .size = size, .seed = seed ^ (size * 0x9E3779B97F4A7C15ull) };
+        size_t n = workers < count ? workers : count;
+        gen.solvers = calloc(n, sizeof(Solver));
+        gen.puzzles = malloc(count * sizeof(Puzzle));
+        if (!gen.solvers || !gen.puzzles) {
+            perror("malloc");
+            exit(EXIT_FAILURE);
         }
-        else if (c == '\r') break;
-        else if (c == 'q') { sel = (int)count; break; } /* quick exit */
-#else
-        {
-            ssize_t n = read(STDIN_FILENO, &c, 1);
-            if (n <= 0) break;
+        for (size_t w = 0; w < n; w++)
+            gen.solvers[w] = (Solver){ .bg = InitBitGame(NULL, size), .strategy = FindBranchStrategy("line") };
+        RunTasks(n, count, GenerateTask, &gen);
+
+        uint64_t rng = gen.seed;
+        size_t recordLen = size * size / 4;
+        for (size_t k = 0; k < count; k++) {
+            const Puzzle *p = &gen.puzzles[k];
+            Line easy[BIT_MAX_SIZE];
+            for (size_t i = 0; i < size; i++) {
+                easy[i] = p->clues[i];
+                for (Line removed = FullLine(size) & ~p->clues[i]; removed; removed &= removed - 1)
+                    if (NextRandom(&rng) & 1) easy[i] |= removed & -removed;
+            }
+            PackMaskGrid(AppendRecord(&puzzles[0], recordLen), size, p->solution, p->clues);
+            PackMaskGrid(AppendRecord(&puzzles[1], recordLen), size, p->solution, easy);
+            PackMaskGrid(AppendRecord(&solutions, recordLen), size, p->solution, NULL);
         }
-        if (c == '\x1b') {
-            char seq[2];
-            if (read(STDIN_FILENO, &seq[0], 1) > 0 &&
-                read(STDIN_FILENO, &seq[1], 1) > 0 && seq[0] == '[') {
-                if      (seq[1] == 'A' && sel > 0)              sel--;  /* up */
-                else if (seq[1] == 'B' && sel < total_items - 1) sel++; /* down */
+        for (size_t w = 0; w < n; w++) FreeBitGame(&gen.solvers[w].bg);
+        free(gen.solvers);
+        free(gen.puzzles);
+    }
+
+    for (int d = 0; d < 2; d++) {
+        BenchSet set = {0};
+        snprintf(set.name, sizeof(set.name), "%zux%zu-%s", size, size, kinds[d]);
+        if (loaded) {
+            BenchAddRecords(&set, size, packs[d].puzzles, packs[d].solutions, packs[d].count);
+            ClosePack(&packs[d]);
+        }
+        else {
+            BenchAddRecords(&set, size, puzzles[d].items, solutions.items, count);
+            int err = corpusDir ? WritePack(paths[d], size, &puzzles[d], &solutions) : 0;
+            if (err) fprintf(stderr, "%s: %s\n", paths[d], strerror(err));
+            free(puzzles[d].items);
+        }
+        da_append(sets, set);
+    }
+    free(solutions.items);
+}
+
+/* The levels, solved beforehand to have something to check */
+static void BenchLoadLevels(BenchSets *sets, const char *dir, const BranchStrategy *strategy)
+{
+    Paths paths = {0};
+    ListLevels(dir, &paths);
+    BenchSet set = { .name = "levels" };
+    nob_da_foreach(char*, path, &paths) {
+        FILE *f = fopen(*path, "rb");
+        Game puzzle = {0};
+        int read = f ? ReadLevel(f, &puzzle) : 0;
+        if (f) fclose(f);
+        if (read != 1) {
+            FreeGame(&puzzle);
+            continue;
+        }
+        Game solution = CloneGame(&puzzle);
+        if (Solve(NULL, NULL, &solution, strategy, NULL) != WIN) FreeGame(&solution);
+        BenchAddGrid(&set, puzzle, solution);
+    }
+    FreePaths(&paths);
+    if (set.count) da_append(sets, set);
+}
+
+static int CompareNs(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/* Every grid of the set `rounds` times through one operation, on the calling thread */
+static BenchResult BenchRun(const BenchSet *set, int op, size_t rounds, const BranchStrategy *strategy, Arena *arena)
+{
+    BenchResult r = { .fingerprint = set->fingerprint };
+    snprintf(r.set, sizeof(r.set), "%s", set->name);
+    snprintf(r.op, sizeof(r.op), "%s", benchOps[op]);
+    uint64_t *samples = malloc((set->count * rounds + 1) * sizeof(uint64_t));
+    Game scratch = InitGame(BIT_MAX_SIZE);
+    if (!samples) {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+
+    uint64_t total = 0;
+    for (size_t round = 0; round < rounds; round++) {
+        for (size_t k = 0; k < set->count; k++) {
+            const Game *src = op == BENCH_CHECK ? &set->solutions[k] : &set->puzzles[k];
+            if (!src->size) continue;
+            scratch.size = src->size;
+            memcpy(scratch.array, src->array, src->size * src->size * sizeof(Cell));
+            ArenaReset(arena);
+
+            uint64_t start = NowNs();
+            switch (op) {
+            case BENCH_EVIDENT: EvidentSolve(&scratch); break;
+            case BENCH_SOLVE:   Solve(arena, NULL, &scratch, strategy, NULL); break;
+            case BENCH_CHECK:   checkWin(&scratch); break;
             }
+            uint64_t ns = NowNs() - start;
+            samples[r.calls++] = ns;
+            total += ns;
         }
-        else if (c == '\r' || c == '\n') break;
-        else if (c == 'q') { sel = (int)count; break; } /* quick exit */
-#endif
     }
 
-    printf("\x1b[?25h"); /* restore cursor */
-    fflush(stdout);
-    disableRawMode();
+    /* Nearest-rank percentiles */
+    if (r.calls) {
+        qsort(samples, r.calls, sizeof(uint64_t), CompareNs);
+        r.p50 = samples[(r.calls + 1) / 2 - 1];
+        r.p99 = samples[(r.calls * 99 + 99) / 100 - 1];
+        r.max = samples[r.calls - 1];
+        r.rate = total ? (double)r.calls * 1e9 / (double)total : 0.0;
+    }
+    FreeGame(&scratch);
+    free(samples);
+    return r;
+}
 
-    if (sel < (int)count) {
-        Game game = LoadLevel(paths[sel]);
-        char solPath[270];
-        snprintf(solPath, sizeof(solPath), "%s.sol", paths[sel]);
-        LoadSolution(solPath, game.size);
-        return game;
+/* Baseline file: '#' comments, then one result per line:
+     set op fingerprint calls calls/s p50_ns p99_ns max_ns
+   Returns 0, or an errno value. */
+static int ReadBaseline(const char *path, BenchResults *out)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) return errno;
+    char line[512];
+    while (fgets(line, sizeof(line), f)) {
+        BenchResult r = {0};
+        unsigned long long fp, p50, p99, max;
+        if (line[0] == '#') continue;
+        if (sscanf(line, "%31s %15s %llx %zu %lf %llu %llu %llu", r.set, r.op, &fp, &r.calls, &r.rate,
+                   &p50, &p99, &max) != 8) continue;
+        r.fingerprint = fp;
+        r.p50 = p50;
+        r.p99 = p99;
+        r.max = max;
+        da_append(out, r);
     }
-    else if (sel == (int)count) {
-        return (Game) {0};
+    fclose(f);
+    return 0;
+}
+
+static int WriteBaseline(const char *path, const BenchResults *results, uint64_t seed, size_t rounds, const char *strategy)
+{
+    FILE *f = fopen(path, "wb");
+    if (!f) return errno;
+    fprintf(f, "# binero bench, seed %llu, %zu rounds, branching %s\n", (unsigned long long)seed, rounds, strategy);
+    fprintf(f, "# set op fingerprint calls calls/s p50_ns p99_ns max_ns\n");
+    nob_da_foreach(BenchResult, r, results)
+        fprintf(f, "%s %s %016llx %zu %.1f %llu %llu %llu\n", r->set, r->op, (unsigned long long)r->fingerprint,
+                r->calls, r->rate, (unsigned long long)r->p50, (unsigned long long)r->p99, (unsigned long long)r->max);
+    int err = ferror(f) ? EIO : 0;
+    if (fclose(f) != 0 && !err) err = errno;
+    return err;
+}
+
+static int BenchCommand(int argc, char **argv)
+{
+    uint64_t seed = 1;
+    size_t rounds = 3, maxSize = 16;
+    double tolerance = 10.0;
+    const char *corpusDir = NULL, *levelsDir = "levels", *baselinePath = NULL, *savePath = NULL;
+    const BranchStrategy *strategy = &branchStrategies[0];
+    for (int i = 0; i < argc; i++) {
+        if ((strcmp(argv[i], "-b") == 0 || strcmp(argv[i], "--branch") == 0) && i + 1 < argc) {
+            if (!(strategy = FindBranchStrategy(argv[++i]))) return 2;
+        }
+        else if ((strcmp(argv[i], "-r") == 0 || strcmp(argv[i], "--seed") == 0) && i + 1 < argc)
+            seed = strtoull(argv[++i], NULL, 10);
+        else if ((strcmp(argv[i], "-n") == 0 || strcmp(argv[i], "--rounds") == 0) && i + 1 < argc)
+            rounds = strtoul(argv[++i], NULL, 10);
+        else if ((strcmp(argv[i], "-z") == 0 || strcmp(argv[i], "--max-size") == 0) && i + 1 < argc)
+            maxSize = strtoul(argv[++i], NULL, 10);
+        else if ((strcmp(argv[i], "-c") == 0 || strcmp(argv[i], "--corpus") == 0) && i + 1 < argc)
+            corpusDir = argv[++i];
+        else if ((strcmp(argv[i], "-L") == 0 || strcmp(argv[i], "--levels") == 0) && i + 1 < argc)
+            levelsDir = argv[++i];
+        else if ((strcmp(argv[i], "-B") == 0 || strcmp(argv[i], "--baseline") == 0) && i + 1 < argc)
+            baselinePath = argv[++i];
+        else if ((strcmp(argv[i], "-w") == 0 || strcmp(argv[i], "--write") == 0) && i + 1 < argc)
+            savePath = argv[++i];
+        else if ((strcmp(argv[i], "-T") == 0 || strcmp(argv[i], "--tolerance") == 0) && i + 1 < argc)
+            tolerance = strtod(argv[++i], NULL);
+        else {
+            PrintUsage(stderr);
+            return 2;
+        }
+    }
+    if (rounds == 0) rounds = 1;
+
+    BenchResults baseline = {0};
+    if (baselinePath) {
+        int err = ReadBaseline(baselinePath, &baseline);
+        if (err) fprintf(stderr, "%s: %s, nothing to compare with\n", baselinePath, strerror(err));
+    }
+
+    uint64_t start = NowNs();
+    BenchSets sets = {0};
+    for (size_t s = 0; s < sizeof(benchSizes) / sizeof(benchSizes[0]); s++)
+        if (benchSizes[s].size <= maxSize)
+            BenchLoadSize(&sets, benchSizes[s].size, benchSizes[s].count, seed, corpusDir, CpuCount());
+    if (*levelsDir) BenchLoadLevels(&sets, levelsDir, strategy);
+    fprintf(stderr, "corpus: %zu sets (seed %llu) ready in %.3f ms, %zu rounds, branching %s\n", sets.count,
+            (unsigned long long)seed, (double)(NowNs() - start) / 1e6, rounds, strategy->name);
+
+    printf("%-16s %-8s %7s %12s %10s %10s %10s  %s\n", "set", "op", "calls", "calls/s", "p50 us", "p99 us", "max us",
+           baseline.count ? "p50 vs baseline" : "");
+    BenchResults results = {0};
+    Arena arena = InitArena(ARENA_DEFAULT_SIZE);
+    int regressions = 0;
+    nob_da_foreach(BenchSet, set, &sets) {
+        for (int op = 0; op < BENCH_OP_COUNT; op++) {
+            BenchResult r = BenchRun(set, op, rounds, strategy, &arena);
+            da_append(&results, r);
+            printf("%-16s %-8s %7zu %12.1f %10.3f %10.3f %10.3f", r.set, r.op, r.calls, r.rate,
+                   (double)r.p50 / 1e3, (double)r.p99 / 1e3, (double)r.max / 1e3);
+            nob_da_foreach(BenchResult, b, &baseline) {
+                if (strcmp(b->set, r.set) != 0 || strcmp(b->op, r.op) != 0) continue;
+                if (b->fingerprint != r.fingerprint) printf("  (other corpus)");
+                else if (b->p50) {
+                    double delta = ((double)r.p50 - (double)b->p50) * 100.0 / (double)b->p50;
+                    int regressed = delta > tolerance;
+                    regressions += regressed;
+                    printf("  %+.1f%%%s", delta, regressed ? " REGRESSION" : "");
+                }
+                break;
+            }
+            printf("\n");
+            fflush(stdout);
+        }
     }
+    FreeArena(&arena);
+
+    int err = savePath ? WriteBaseline(savePath, &results, seed, rounds, strategy->name) : 0;
+    if (err) fprintf(stderr, "%s: %s\n", savePath, strerror(err));
+    if (regressions) fprintf(stderr, "%d regressions over %.1f%%\n", regressions, tolerance);
 
-    return InitGame(14);
+    nob_da_foreach(BenchSet, set, &sets) FreeBenchSet(set);
+    da_free(&sets);
+    da_free(&results);
+    da_free(&baseline);
+    return err || regressions ? 1 : 0;
 }
 
-int main(void)
+typedef struct {
+    const char *name;
+    int (*run)(int argc, char **argv);
+} Command;
+
+static const Command commands[] = {
+    { "solve", SolveCommand },
+    { "count", CountCommand },
+    { "generate", GenerateCommand },
+    { "pack", PackCommand },
+    { "unpack", UnpackCommand },
+    { "bench", BenchCommand },
+};
+
+int main(int argc, char **argv)
 {
+    if (argc > 1) {
+        for (size_t i = 0; i < sizeof(commands) / sizeof(commands[0]); i++)
+            if (strcmp(argv[1], commands[i].name) == 0)
+                return commands[i].run(argc - 2, argv + 2);
+        PrintUsage(strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0 ? stdout : stderr);
+        return 2;
+    }
+
     Game game = SelectLevel();
     if (game.size == 0) {
         // Clear screen and exit if no level selected
@@ -760,9 +4498,11 @@ int main(void)
         return 0;
     }
     enableRawMode();
+    size_t strategy = BRANCH_STRATEGY_COUNT; /* past the table: DefaultStrategy */
     
     while (1) {
-        PrintGame(&game);
+        /* Keys that arrived together (a paste, key repeat over a slow link) make one frame */
+        if (!InputPending()) PrintGame(&game);
         char win = 0;
         char c;
 #ifdef _WIN32
@@ -783,18 +4523,31 @@ int main(void)
         else if (c == -87) QuotaExhaustedRule(&game); // é
         else if (c == 's') 
          {
-            clock_t start = clock();
-            EvidentSolve(&game);
-            clock_t end = clock();
-            double time_spent = ((double)(end - start));
-            printf("Solved in %.0f micro seconds\n", time_spent);
+            uint64_t start = NowNs();
+            size_t status = EvidentSolve(&game);
+            double us = (double)(NowNs() - start) / 1e3;
+            if (status == CONFLICT)
+                ShowMessage("Contradiction: la grille n'a pas de solution");
+            else
+                ShowMessage("Solved in %.1f micro seconds", us);
         }
         else if (c == 'S') {
-            clock_t start = clock();
-            Solve(&game);
-            clock_t end = clock();
-            double time_spent = ((double)(end - start));
-            printf("Solved in %.0f micro seconds\n", time_spent);
+            uint64_t start = NowNs();
+            SolverStats stats;
+            const BranchStrategy *picked = strategy < BRANCH_STRATEGY_COUNT
+                ? &branchStrategies[strategy] : DefaultStrategy(game.size);
+            size_t status = Solve(NULL, NULL, &game, picked, &stats);
+            double us = (double)(NowNs() - start) / 1e3;
+            if (status != WIN)
+                ShowMessage("Impossible: la grille n'a pas de solution (%.1f micro seconds, %zu nodes, %s)",
+                            us, stats.nodes, picked->name);
+            else
+                ShowMessage("Solved in %.1f micro seconds, %zu nodes, depth %zu, %zu propagations (%s)",
+                            us, stats.nodes, stats.maxDepth, stats.prop.passes, picked->name);
+        }
+        else if (c == 'b') {
+            strategy = (strategy + 1) % (BRANCH_STRATEGY_COUNT + 1);
+            ShowMessage("Branchement: %s", strategy < BRANCH_STRATEGY_COUNT ? branchStrategies[strategy].name : "auto");
         }
         else if (c == 'x') ExportLevel(&game);
         else if (c == 'w') win = checkWin(&game);
@@ -821,11 +4574,11 @@ int main(void)
         }
 #endif
         else {
-            printf("Touche non reconnue: %d\n", c);
+            ShowMessage("Touche non reconnue: %d", c);
         }
         if (win == WIN) {
-            printf("Congratulations! You've won the game!\n");
-            printf("Press any key to exit...\n");
+            ShowMessage("Congratulations! You've won the game!\nPress any key to exit...");
+            PrintGame(&game);
 #ifdef _WIN32
             _getch();
 #else